@@ -0,0 +1,101 @@
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+
+#include "characteristic.h"
+#include "crypto_options.h"
+#include "cxxopts.hpp"
+#include "logfile.h"
+#include "search.h"
+#include "tool_options.h"
+#include "xml_config.h"
+
+#ifdef ALLOCCHECK_BACKTRACE
+#include <execinfo.h>
+#endif
+
+// counts the heap allocations while enabled
+static bool count_allocations = false;
+static uint64_t num_allocations = 0;
+
+static void* Allocate(std::size_t size) {
+  if (count_allocations) {
+    num_allocations++;
+#ifdef ALLOCCHECK_BACKTRACE
+    count_allocations = false;
+    void* frames[16];
+    backtrace_symbols_fd(frames, backtrace(frames, 16), 2);
+    std::cerr << std::endl;
+    count_allocations = true;
+#endif
+  }
+  void* ptr = std::malloc(size ? size : 1);
+  if (ptr == nullptr) throw std::bad_alloc();
+  return ptr;
+}
+
+void* operator new(std::size_t size) { return Allocate(size); }
+void* operator new[](std::size_t size) { return Allocate(size); }
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+int main(int argc, char* argv[]) {
+  try {
+    cxxopts::Options options(argv[0],
+                             "Counts the heap allocations of the search loop "
+                             "of nldtool after a warm-up phase.");
+    AddToolOptions(options);
+    options.add_options("Allocations")                     //
+        ("warmup-iterations",                              //
+         "number of search iterations before counting",    //
+         cxxopts::value<int64_t>()->default_value("2000"),  //
+         "N")                                              //
+        ("count-iterations",                               //
+         "number of search iterations to count",           //
+         cxxopts::value<int64_t>()->default_value("2000"),  //
+         "N")                                              //
+        ("max-allocations",                                //
+         "exit with an error if there are more allocations",  //
+         cxxopts::value<int64_t>()->default_value("0"),     //
+         "N");
+    AddCryptoSpecificOptions(options);
+    options.parse(argc, argv);
+
+    if (options.count("help")) {
+      std::cout << options.help({"", "Allocations", "Search"}) << std::endl;
+      exit(0);
+    }
+
+    XmlConfig config(options);
+    if (!options["input-file"].as<std::string>().empty())
+      config.Load(options["input-file"].as<std::string>());
+    Logfile logfile(options["log-file"].as<std::string>());
+    Characteristic characteristic = config.GenerateCharacteristic();
+    Search search(config, characteristic, logfile,
+                  options["stack-frequency"].as<int>(),
+                  options["random-seed"].as<int64_t>());
+    search.Init();
+    for (int64_t i = 0; i < options["warmup-iterations"].as<int64_t>(); ++i)
+      search.Iterate();
+
+    const int64_t iterations = options["count-iterations"].as<int64_t>();
+    count_allocations = true;
+    for (int64_t i = 0; i < iterations; ++i) search.Iterate();
+    count_allocations = false;
+
+    std::cout << num_allocations << " allocations in " << iterations
+              << " iterations" << std::endl;
+    if (num_allocations > options["max-allocations"].as<int64_t>()) {
+      std::cerr << "error: the search loop allocates heap memory" << std::endl;
+      return 1;
+    }
+  } catch (const cxxopts::OptionException& e) {
+    std::cout << "error parsing options: " << e.what() << std::endl;
+    exit(-1);
+  }
+  return 0;
+}
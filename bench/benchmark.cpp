@@ -0,0 +1,67 @@
+#include "benchmark.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+volatile uint64_t sink;
+}
+
+void DoNotOptimize(uint64_t value) { sink = sink ^ value; }
+
+Benchmark::Benchmark(const std::string& filter, double min_time)
+    : filter_(filter), min_time_(min_time) {}
+
+bool Benchmark::IsEnabled(const std::string& name) const {
+  return std::regex_search(name, filter_);
+}
+
+void Benchmark::Run(const std::string& name, int64_t ops_per_call,
+                    const std::function<void()>& f) {
+  if (!IsEnabled(name)) return;
+  Result result = {name, 0, 0};
+  const auto start = std::chrono::steady_clock::now();
+  do {
+    f();
+    result.operations += ops_per_call;
+    result.seconds = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+  } while (result.seconds < min_time_);
+  Report(result);
+}
+
+void Benchmark::RunOnce(const std::string& name, int64_t ops_per_call,
+                        const std::function<void()>& f) {
+  if (!IsEnabled(name)) return;
+  const auto start = std::chrono::steady_clock::now();
+  f();
+  Report({name, ops_per_call,
+          std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                        start)
+              .count()});
+}
+
+void Benchmark::Report(const Result& result) {
+  results_.push_back(result);
+  std::cout << std::left << std::setw(40) << result.name << std::right
+            << std::setw(12) << std::fixed << std::setprecision(1)
+            << 1e9 * result.seconds / result.operations << " ns/op"
+            << std::setw(12) << result.operations << " ops" << std::endl;
+  std::cout.unsetf(std::ios::floatfield);
+}
+
+void Benchmark::WriteJson(std::ostream& os, const std::string& version,
+                          uint64_t seed) const {
+  os << "{\"version\":\"" << version << "\",\"seed\":" << seed;
+  os << ",\"benchmarks\":[";
+  for (int i = 0; i < results_.size(); ++i) {
+    const Result& r = results_[i];
+    os << (i ? "," : "") << "\n  {\"name\":\"" << r.name << "\"";
+    os << ",\"operations\":" << r.operations;
+    os << ",\"seconds\":" << r.seconds;
+    os << ",\"ns_per_op\":" << 1e9 * r.seconds / r.operations << "}";
+  }
+  os << "\n]}" << std::endl;
+}
@@ -0,0 +1,54 @@
+#ifndef BENCHMARK_H_
+#define BENCHMARK_H_
+
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <regex>
+#include <string>
+#include <vector>
+
+/*!
+ * \brief Minimal harness that times named benchmark functions and writes the
+ * results as JSON.
+ *
+ * A benchmark function performs a fixed number of operations per call. It is
+ * called repeatedly until the minimal time has elapsed, and the time per
+ * operation is reported. Benchmarks whose name does not match the filter are
+ * skipped.
+ */
+class Benchmark {
+ public:
+  struct Result {
+    std::string name;
+    int64_t operations;
+    double seconds;
+  };
+
+  Benchmark(const std::string& filter, double min_time);
+
+  bool IsEnabled(const std::string& name) const;
+
+  // calls f (which performs ops_per_call operations) until min_time elapsed
+  void Run(const std::string& name, int64_t ops_per_call,
+           const std::function<void()>& f);
+
+  // calls f exactly once, e.g. for measuring cold caches
+  void RunOnce(const std::string& name, int64_t ops_per_call,
+               const std::function<void()>& f);
+
+  void WriteJson(std::ostream& os, const std::string& version,
+                 uint64_t seed) const;
+
+ private:
+  void Report(const Result& result);
+
+  std::regex filter_;
+  double min_time_;
+  std::vector<Result> results_;
+};
+
+// prevents the compiler from optimizing away benchmarked computations
+void DoNotOptimize(uint64_t value);
+
+#endif  // BENCHMARK_H_
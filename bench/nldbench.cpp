@@ -0,0 +1,348 @@
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "benchmark.h"
+#include "bitslice.h"
+#include "characteristic.h"
+#include "crypto.h"
+#include "crypto_factory.h"
+#include "crypto_options.h"
+#include "cxxopts.hpp"
+#include "functions.h"
+#include "linear_matrix.h"
+#include "search_stack.h"
+
+constexpr auto version_string = "nldbench v1.0.0";
+
+// a 3-bit S-box for the SBOX benchmark
+struct Sbox3 {
+  static constexpr uint8_t LUT[8] = {0, 1, 3, 6, 7, 4, 5, 2};
+};
+constexpr uint8_t Sbox3::LUT[];
+
+uint64_t RandomCondition(std::mt19937_64& rng, int num_bits) {
+  const uint64_t mask = nldtool::Mask(1ull << (2 * num_bits));
+  uint64_t condition;
+  do {
+    condition = rng() & mask;
+  } while (condition == 0);
+  return condition;
+}
+
+template <class F>
+std::vector<BitsliceData<F>> RandomInputs(std::mt19937_64& rng, int count) {
+  std::vector<BitsliceData<F>> inputs(count);
+  for (BitsliceData<F>& input : inputs)
+    for (int i = 0; i < F::kNumInputs + F::kNumOutputs; i++)
+      input.SetCondition(i, RandomCondition(rng, F::Bitsize(i)));
+  return inputs;
+}
+
+template <class F>
+void BenchLoop(Benchmark& bench, std::mt19937_64& rng,
+               const std::string& name) {
+  const std::vector<BitsliceData<F>> inputs = RandomInputs<F>(rng, 256);
+  bench.Run("Loop/" + name, inputs.size(), [&inputs]() {
+    for (const BitsliceData<F>& input : inputs)
+      DoNotOptimize(Bitslice<F>::template Loop<Propagate<F>>(input));
+  });
+}
+
+template <class F>
+void BenchCompute(Benchmark& bench, std::mt19937_64& rng,
+                  const std::string& name, int count) {
+  if (!bench.IsEnabled("Compute/cold/" + name) &&
+      !bench.IsEnabled("Compute/warm/" + name))
+    return;
+  // caches that are not filled on the fly have to be initialized first
+  if (BitsliceData<F>::NUMBITS <= MAX_STATIC_CACHE_SIZE)
+    Bitslice<F>::InitCaches();
+  const std::vector<BitsliceData<F>> inputs = RandomInputs<F>(rng, count);
+  auto compute = [&inputs]() {
+    for (const BitsliceData<F>& input : inputs)
+      DoNotOptimize(Bitslice<F>::Compute(input));
+  };
+  bench.RunOnce("Compute/cold/" + name, inputs.size(), compute);
+  bench.Run("Compute/warm/" + name, inputs.size(), compute);
+}
+
+void SetOption(cxxopts::Options& options, const std::string& name,
+               const std::string& value) {
+  const_cast<cxxopts::OptionDetails&>(options[name]).parse(value);
+}
+
+CryptoPtr MakeCrypto(cxxopts::Options& options, const std::string& function,
+                     int num_rounds, int word_size) {
+  SetOption(options, "function", function);
+  SetOption(options, "num-rounds", std::to_string(num_rounds));
+  SetOption(options, "word-size", std::to_string(word_size));
+  CryptoPtr crypto(CryptoFactory(options));
+  crypto->SetName(function);
+  crypto->SetNumRounds(num_rounds);
+  return crypto;
+}
+
+// times BitsliceStep::Update of the first step named step_name on random
+// input conditions (including setting them via the condition proxies)
+void BenchStep(Benchmark& bench, std::mt19937_64& rng, CryptoPtr crypto,
+               const std::string& step_name) {
+  const std::string name = "Step/Update/" + step_name;
+  if (!bench.IsEnabled(name)) return;
+  int index = 0;
+  while (index < crypto->GetNumSteps() &&
+         crypto->GetStep(index).GetName() != step_name)
+    index++;
+  if (index == crypto->GetNumSteps()) {
+    std::cerr << "warning: no step " << step_name << " in "
+              << crypto->GetName() << std::endl;
+    return;
+  }
+  const Step& step = crypto->GetStep(index);
+  const int num_samples = 256;
+  std::vector<uint64_t> conditions;
+  for (int k = 0; k < num_samples; ++k)
+    for (int i = 0; i < step.GetNumParams(); ++i)
+      conditions.push_back(RandomCondition(
+          rng, step.GetConditionProxy(i, 0)->GetNumBits()));
+  Characteristic characteristic(crypto);
+  bench.Run(name, num_samples, [&]() {
+    const uint64_t* condition = conditions.data();
+    for (int k = 0; k < num_samples; ++k) {
+      const int bit = k % crypto->GetWordSize();
+      for (int i = 0; i < step.GetNumParams(); ++i)
+        step.GetConditionProxy(i, bit)->SetCondition(characteristic,
+                                                     *condition++);
+      DoNotOptimize(step.Update(characteristic, bit));
+    }
+  });
+}
+
+std::vector<Bitpos> GetMainBits(const CryptoPtr& crypto) {
+  return crypto->GetWordMaskMain().GetBitposList();
+}
+
+// times the propagation after guessing a single random '?' bit to '-' or 'x',
+// the same way Search::GuessBit does it
+void BenchUpdate(Benchmark& bench, std::mt19937_64& rng, CryptoPtr crypto) {
+  const std::string name = "Characteristic/Update/" + crypto->GetName();
+  if (!bench.IsEnabled(name)) return;
+  Characteristic characteristic(crypto);
+  characteristic.UpdateAll();
+  Characteristic tmp(characteristic);
+  const std::vector<Bitpos> bits = GetMainBits(crypto);
+  std::vector<std::pair<Bitpos, BitCondition>> guesses;
+  for (int k = 0; k < 256; ++k)
+    guesses.emplace_back(bits[rng() % bits.size()],
+                         BitCondition(rng() & 1 ? "-" : "x"));
+  bench.Run(name, guesses.size(), [&]() {
+    for (const auto& guess : guesses) {
+      tmp.ShallowCopy(characteristic);
+      tmp.SetBitCondition(guess.first, guess.second);
+      DoNotOptimize(tmp.Update(true));
+      tmp.Undo();
+    }
+  });
+}
+
+void BenchCopy(Benchmark& bench, CryptoPtr crypto) {
+  const std::string name = "Characteristic/Copy/" + crypto->GetName();
+  if (!bench.IsEnabled(name)) return;
+  Characteristic characteristic(crypto);
+  characteristic.UpdateAll();
+  bench.Run(name, 16, [&characteristic]() {
+    for (int k = 0; k < 16; ++k) {
+      Characteristic copy(characteristic);
+      DoNotOptimize(copy.GetContainerCondition1(Bitpos(0, 0)));
+    }
+  });
+}
+
+void BenchMove(Benchmark& bench, CryptoPtr crypto) {
+  const std::string name = "Characteristic/Move/" + crypto->GetName();
+  if (!bench.IsEnabled(name)) return;
+  Characteristic characteristic(crypto);
+  characteristic.UpdateAll();
+  Characteristic other(characteristic);
+  bench.Run(name, 16, [&]() {
+    for (int k = 0; k < 16; ++k) {
+      Characteristic moved(std::move(characteristic));
+      characteristic = std::move(other);
+      other = std::move(moved);
+      DoNotOptimize(characteristic.GetContainerCondition1(Bitpos(0, 0)));
+    }
+  });
+}
+
+// times the mask arithmetic and random bit selection of Search::ChooseGuessPos
+void BenchBitmask(Benchmark& bench, std::mt19937_64& rng, CryptoPtr crypto) {
+  const std::string name = "Bitmask/Random/" + crypto->GetName();
+  if (!bench.IsEnabled(name)) return;
+  const Bitmask main = crypto->GetWordMaskMain();
+  std::vector<Bitmask> masks(16, main);
+  for (Bitmask& mask : masks)
+    for (const Bitpos& pos : main.GetBitposList())
+      if (rng() & 1) mask.ClearBit(pos);
+  Bitmask mask(crypto->GetWordSize());
+  std::mt19937 mask_rng(rng());
+  bench.Run(name, masks.size(), [&]() {
+    for (const Bitmask& other : masks) {
+      mask = main;
+      mask &= other;
+      const Bitpos pos = mask.GetRandomBitpos(mask_rng);
+      DoNotOptimize(pos.GetWord() + mask.GetNumBitsSet());
+    }
+  });
+}
+
+void BenchSearchStack(Benchmark& bench, CryptoPtr crypto) {
+  const std::string name = "SearchStack/PushPop/" + crypto->GetName();
+  if (!bench.IsEnabled(name)) return;
+  Characteristic characteristic(crypto);
+  characteristic.UpdateAll();
+  Characteristic popped(characteristic);
+  SearchStack stack;
+  bench.Run(name, 16, [&]() {
+    for (int k = 0; k < 16; ++k) {
+      stack.push_back(characteristic, 0);
+      DoNotOptimize(stack.get_pop_back(popped));
+    }
+  });
+}
+
+void BenchLinearMatrix(Benchmark& bench, std::mt19937_64& rng) {
+  const std::string name = "LinearMatrix/AddEquation";
+  if (!bench.IsEnabled(name)) return;
+  const int rows = 128, cols = 256;
+  LinearMatrix matrix(rows, cols);
+  std::vector<std::vector<int>> equations;
+  for (int k = 0; k < 256; ++k) {
+    std::set<int> vars;
+    while (vars.size() < 3) vars.insert(rng() % cols);
+    equations.emplace_back(vars.begin(), vars.end());
+  }
+  bench.Run(name, equations.size(), [&]() {
+    bool rhs = false;
+    for (const std::vector<int>& equation : equations) {
+      DoNotOptimize(matrix.AddEquation(equation, rhs = !rhs, true));
+      matrix.Undo();
+    }
+  });
+}
+
+int main(int argc, char* argv[]) {
+  try {
+    cxxopts::Options options(argv[0],
+                             "Microbenchmarks for the bitslice functions and "
+                             "the propagation of nldtool.");
+    options.add_options()                                               //
+        ("h,help",                                                      //
+         "print help",                                                  //
+         cxxopts::value<bool>(),                                        //
+         "")                                                            //
+        ("o,output-file",                                               //
+         "JSON file with the results",                                  //
+         cxxopts::value<std::string>()->default_value("nldbench.json"),  //
+         "FILE")                                                        //
+        ("b,benchmark",                                                 //
+         "only run benchmarks matching the regular expression",        //
+         cxxopts::value<std::string>()->default_value("."),             //
+         "REGEX")                                                       //
+        ("t,min-time",                                                  //
+         "minimal time per benchmark in seconds",                       //
+         cxxopts::value<double>()->default_value("0.5"),                //
+         "T")                                                           //
+        ("R,random-seed",                                               //
+         "random seed for the benchmark inputs",                        //
+         cxxopts::value<int64_t>()->default_value("1"),                 //
+         "SEED");
+
+    // options needed to construct the crypto functions
+    options.add_options("Crypto")                             //
+        ("s,start-round",                                     //
+         "start round",                                       //
+         cxxopts::value<int>()->default_value("0"),           //
+         "N")                                                 //
+        ("n,num-rounds",                                      //
+         "number of rounds",                                  //
+         cxxopts::value<int>()->default_value("1"),           //
+         "N")                                                 //
+        ("r,rate",                                            //
+         "rate of a sponge function",                         //
+         cxxopts::value<int>()->default_value("64"),          //
+         "N")                                                 //
+        ("blocks",                                            //
+         "number of message blocks",                          //
+         cxxopts::value<int>()->default_value("1"),           //
+         "N")                                                 //
+        ("w,word-size",                                       //
+         "word size",                                         //
+         cxxopts::value<int>()->default_value("32"),          //
+         "N")                                                 //
+        ("f,function",                                        //
+         "cryptographic function",                            //
+         cxxopts::value<std::string>()->default_value("md4"),  //
+         "F");
+    AddCryptoSpecificOptions(options);
+    options.parse(argc, argv);
+
+    if (options.count("help")) {
+      std::cout << options.help({""}) << std::endl;
+      exit(0);
+    }
+
+    const uint64_t seed = options["random-seed"].as<int64_t>();
+    std::mt19937_64 rng(seed);
+    Benchmark bench(options["benchmark"].as<std::string>(),
+                    options["min-time"].as<double>());
+
+    BenchLoop<IF>(bench, rng, "IF");
+    BenchLoop<MAJ>(bench, rng, "MAJ");
+    BenchLoop<XOR<3>>(bench, rng, "XOR<3>");
+    BenchLoop<ADD<4>>(bench, rng, "ADD<4>");
+    BenchLoop<SBOX<3, 3, Sbox3::LUT>>(bench, rng, "SBOX<3,3>");
+
+    BenchCompute<MAJ>(bench, rng, "MAJ", 4096);
+    BenchCompute<ADD<4>>(bench, rng, "ADD<4>", 4096);
+    BenchCompute<XOR<4>>(bench, rng, "XOR<4>", 4096);
+    BenchCompute<XORB<3>>(bench, rng, "XORB<3>", 4096);
+    BenchCompute<SBOX<3, 3, Sbox3::LUT>>(bench, rng, "SBOX<3,3>", 4096);
+    BenchCompute<ADDB<2>>(bench, rng, "ADDB<2>", 4096);
+
+    BenchLinearMatrix(bench, rng);
+
+    CryptoPtr md4 = MakeCrypto(options, "md4", 48, 32);
+    BenchUpdate(bench, rng, md4);
+    BenchCopy(bench, md4);
+    BenchMove(bench, md4);
+    BenchSearchStack(bench, md4);
+
+    CryptoPtr sha2 = MakeCrypto(options, "sha2", 27, 32);
+    BenchStep(bench, rng, sha2, "SADD");
+    BenchUpdate(bench, rng, sha2);
+    BenchCopy(bench, sha2);
+    BenchMove(bench, sha2);
+    BenchBitmask(bench, rng, sha2);
+
+    CryptoPtr siphash = MakeCrypto(options, "siphash", 18, 64);
+    BenchStep(bench, rng, siphash, "ADD2U1U1ROT");
+
+    std::ofstream file(options["output-file"].as<std::string>());
+    if (!file) {
+      std::cerr << "error: writing file '"
+                << options["output-file"].as<std::string>() << "'"
+                << std::endl;
+      exit(-1);
+    }
+    bench.WriteJson(file, version_string, seed);
+  } catch (const cxxopts::OptionException& e) {
+    std::cout << "error parsing options: " << e.what() << std::endl;
+    exit(-1);
+  }
+  return 0;
+}
@@ -0,0 +1,174 @@
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <regex>
+#include <string>
+
+#include "bitslice.h"
+#include "cxxopts.hpp"
+#include "functions.h"
+
+#ifdef NLDPROPCHECK_ASCON
+#include "ascon/ascon.h"
+#endif
+#ifdef NLDPROPCHECK_MD5
+#include "md5/md5.h"
+#endif
+#ifdef NLDPROPCHECK_RIPEMD160
+#include "ripemd160/ripemd160.h"
+#endif
+#ifdef NLDPROPCHECK_SHA2
+#include "sha2/sha2.h"
+#endif
+#ifdef NLDPROPCHECK_SIPHASH
+#include "siphash/siphash.h"
+#endif
+
+// S-boxes with fewer inputs than the ones of the crypto functions
+struct Sbox3 {
+  static constexpr uint8_t LUT[8] = {0, 1, 3, 6, 7, 4, 5, 2};
+};
+constexpr uint8_t Sbox3::LUT[];
+
+struct Sbox4 {
+  static constexpr uint8_t LUT[16] = {12, 5, 6,  11, 9, 0, 10, 13,
+                                      3,  14, 15, 8, 4, 7, 1,  2};
+};
+constexpr uint8_t Sbox4::LUT[];
+
+/*!
+ * \brief Compares the direct propagation of Bitslice<F>::Compute with the
+ * Propagate action in the Loop over all pairs on random inputs.
+ *
+ * Compute does not use the cache and the Loop for the functions with a
+ * \see CarryAutomaton, \see XorSumset or \see SboxTable, so their results
+ * have to be exactly the same.
+ */
+class PropagationCheck {
+ public:
+  PropagationCheck(const std::string& filter, int num_inputs, uint64_t seed)
+      : filter_(filter), num_inputs_(num_inputs), rng_(seed), failed_(false) {}
+
+  template <class F>
+  void Run(const std::string& name) {
+    if (!std::regex_search(name, filter_)) return;
+    static_assert(Bitslice<F>::HasDirectPropagation(),
+                  "the function is propagated with the cache");
+    int mismatches = 0, solutions = 0;
+    for (int k = 0; k < num_inputs_; k++) {
+      BitsliceData<F> input;
+      for (int i = 0; i < F::kNumInputs + F::kNumOutputs; i++)
+        input.SetCondition(i, RandomCondition(F::Bitsize(i)));
+      BitsliceData<F> computed = Bitslice<F>::Compute(input);
+      const BitsliceData<F> expected =
+          Bitslice<F>::template Loop<Propagate<F>>(input);
+      if (expected.GetCondition(0)) solutions++;
+      if (computed.Compare(expected)) continue;
+      if (mismatches++ == 0)
+        std::cerr << "error: " << name << " input " << input << ": computed "
+                  << computed << ", loop " << expected << std::endl;
+    }
+    std::cout << name << ": " << num_inputs_ << " inputs (" << solutions
+              << " with solutions), " << mismatches << " mismatches"
+              << std::endl;
+    if (mismatches) failed_ = true;
+  }
+
+  bool Failed() const { return failed_; }
+
+ private:
+  // sparse conditions lead to contradictions, dense ones to many pairs; an
+  // empty condition would make every result empty
+  uint64_t RandomCondition(int num_bits) {
+    const uint64_t mask = nldtool::Mask(1ull << (2 * num_bits));
+    uint64_t condition;
+    do {
+      condition = rng_();
+      for (int k = rng_() % 4; k > 0; k--) condition &= rng_();
+      condition &= mask;
+    } while (condition == 0);
+    return condition;
+  }
+
+  std::regex filter_;
+  int num_inputs_;
+  std::mt19937_64 rng_;
+  bool failed_;
+};
+
+int main(int argc, char* argv[]) {
+  try {
+    cxxopts::Options options(argv[0],
+                             "Checks the direct propagation of the bitslice "
+                             "functions against the Loop over all pairs.");
+    options.add_options()                                   //
+        ("h,help",                                          //
+         "print help",                                      //
+         cxxopts::value<bool>(),                            //
+         "")                                                //
+        ("c,check",                                         //
+         "only run checks matching the regular expression",  //
+         cxxopts::value<std::string>()->default_value("."),  //
+         "REGEX")                                           //
+        ("k,num-inputs",                                    //
+         "number of random inputs per function",            //
+         cxxopts::value<int>()->default_value("10000"),     //
+         "N")                                               //
+        ("R,random-seed",                                   //
+         "random seed for the inputs",                      //
+         cxxopts::value<int64_t>()->default_value("1"),     //
+         "SEED");
+    options.parse(argc, argv);
+
+    if (options.count("help")) {
+      std::cout << options.help({""}) << std::endl;
+      exit(0);
+    }
+
+    PropagationCheck check(options["check"].as<std::string>(),
+                           options["num-inputs"].as<int>(),
+                           options["random-seed"].as<int64_t>());
+
+    // the modular additions of the crypto functions
+    check.Run<ADD<2>>("ADD<2>");
+    check.Run<ADD<3>>("ADD<3>");
+    check.Run<ADD<4>>("ADD<4>");
+    check.Run<ADD<5>>("ADD<5>");
+    check.Run<ADD<6>>("ADD<6>");
+    check.Run<ADDB<2>>("ADDB<2>");
+#ifdef NLDPROPCHECK_MD5
+    check.Run<Md5::ADD4ADD2>("ADD4ADD2/md5");
+#endif
+#ifdef NLDPROPCHECK_RIPEMD160
+    check.Run<Ripemd160::ADD4ADD2>("ADD4ADD2/ripemd160");
+#endif
+#ifdef NLDPROPCHECK_SHA2
+    check.Run<Sha2::SADD>("SADD/sha2");
+#endif
+#ifdef NLDPROPCHECK_SIPHASH
+    check.Run<Siphash::ADD2U1U1ROT>("ADD2U1U1ROT/siphash");
+#endif
+
+    // the XORs that are propagated with the sums of pair sets
+    check.Run<XOR<3>>("XOR<3>");
+    check.Run<XOR<4>>("XOR<4>");
+    check.Run<XOR<5>>("XOR<5>");
+    check.Run<XORB<2>>("XORB<2>");
+    check.Run<XORB<3>>("XORB<3>");
+    check.Run<XORB<4>>("XORB<4>");
+    check.Run<XORB<5>>("XORB<5>");
+
+    // the S-boxes that are propagated with precomputed pair sets
+    check.Run<SBOX<3, 3, Sbox3::LUT>>("SBOX<3,3>");
+    check.Run<SBOX<4, 4, Sbox4::LUT>>("SBOX<4,4>");
+#ifdef NLDPROPCHECK_ASCON
+    check.Run<SBOX<5, 5, Ascon::LUT>>("SBOX<5,5>/ascon");
+#endif
+
+    return check.Failed() ? 1 : 0;
+  } catch (const cxxopts::OptionException& e) {
+    std::cout << "error parsing options: " << e.what() << std::endl;
+    exit(-1);
+  }
+}
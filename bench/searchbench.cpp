@@ -0,0 +1,401 @@
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "cxxopts.hpp"
+
+constexpr auto version_string = "nldsearchbench v1.0.0";
+
+#ifndef NLDTOOL_EXAMPLES_DIR
+#define NLDTOOL_EXAMPLES_DIR "examples"
+#endif
+
+/*!
+ * \brief A search configuration of the examples folder that is benchmarked.
+ */
+struct SearchConfig {
+  const char* name;
+  const char* file;
+};
+
+const SearchConfig kSearchConfigs[] = {
+    {"md4_wang", "md4/eurocryptWangLFCY05/start.xml"},
+    {"sha1", "sha1/cryptoWangYY05a/80-firstblock.xml"},
+    {"sha2_27", "sha2/asiacryptMendelNS11/27_256_coll_start.xml"},
+    {"sm3", "sm3/ctrsaMendelNS13/20-start.xml"},
+    {"skein", "skein/cryptoLeurent13/free_6.xml"},
+    {"keccak", "keccak/imaKolblMNS13/r4_w64_n256.xml"},
+};
+
+/*!
+ * \brief The measurements of all runs (one per seed) of a configuration.
+ */
+struct Measurements {
+  std::string name;
+  std::vector<double> iterations_per_sec;
+  std::vector<double> restarts_per_sec;
+  std::vector<double> first_found_time;  // -1 if nothing was found
+  std::vector<double> peak_rss_kb;
+};
+
+// extracts the number following "key": in a line of JSON
+bool ParseNumber(const std::string& line, const std::string& key,
+                 double& value) {
+  size_t pos = line.find("\"" + key + "\":");
+  if (pos == std::string::npos) return false;
+  std::istringstream is(line.substr(pos + key.size() + 3));
+  return bool(is >> value);
+}
+
+// extracts the string following "key": in a line of JSON
+std::string ParseString(const std::string& line, const std::string& key) {
+  size_t pos = line.find("\"" + key + "\":\"");
+  if (pos == std::string::npos) return "";
+  pos += key.size() + 4;
+  return line.substr(pos, line.find('"', pos) - pos);
+}
+
+// extracts the array of numbers following "key": in a line of JSON
+std::vector<double> ParseArray(const std::string& line,
+                               const std::string& key) {
+  std::vector<double> values;
+  size_t pos = line.find("\"" + key + "\":[");
+  if (pos == std::string::npos) return values;
+  pos += key.size() + 4;
+  std::istringstream is(line.substr(pos, line.find(']', pos) - pos));
+  double value;
+  while (is >> value) {
+    values.push_back(value);
+    is.ignore(1, ',');
+  }
+  return values;
+}
+
+void WriteArray(std::ostream& os, const std::string& key,
+                const std::vector<double>& values) {
+  os << ",\"" << key << "\":[";
+  for (int i = 0; i < values.size(); ++i) os << (i ? "," : "") << values[i];
+  os << "]";
+}
+
+void WriteJson(std::ostream& os, const std::vector<Measurements>& results,
+               const std::vector<int64_t>& seeds, int end_time,
+               int64_t end_iterations) {
+  os << "{\"version\":\"" << version_string << "\",\"seeds\":[";
+  for (int i = 0; i < seeds.size(); ++i) os << (i ? "," : "") << seeds[i];
+  os << "],\"end_time\":" << end_time;
+  os << ",\"end_iterations\":" << end_iterations << ",\"configs\":[";
+  // one configuration per line, see ReadBaseline
+  for (int i = 0; i < results.size(); ++i) {
+    const Measurements& m = results[i];
+    os << (i ? "," : "") << "\n  {\"name\":\"" << m.name << "\"";
+    WriteArray(os, "iterations_per_sec", m.iterations_per_sec);
+    WriteArray(os, "restarts_per_sec", m.restarts_per_sec);
+    WriteArray(os, "first_found_time", m.first_found_time);
+    WriteArray(os, "peak_rss_kb", m.peak_rss_kb);
+    os << "}";
+  }
+  os << "\n]}" << std::endl;
+}
+
+bool ReadBaseline(const std::string& file_name,
+                  std::map<std::string, Measurements>& baseline) {
+  std::ifstream file(file_name);
+  if (!file) return false;
+  std::string line;
+  while (std::getline(file, line)) {
+    Measurements m;
+    m.name = ParseString(line, "name");
+    if (m.name.empty()) continue;
+    m.iterations_per_sec = ParseArray(line, "iterations_per_sec");
+    m.restarts_per_sec = ParseArray(line, "restarts_per_sec");
+    m.first_found_time = ParseArray(line, "first_found_time");
+    m.peak_rss_kb = ParseArray(line, "peak_rss_kb");
+    baseline[m.name] = m;
+  }
+  return true;
+}
+
+double Mean(const std::vector<double>& x) {
+  double sum = 0;
+  for (double v : x) sum += v;
+  return x.empty() ? 0 : sum / x.size();
+}
+
+double Variance(const std::vector<double>& x) {
+  if (x.size() < 2) return 0;
+  const double mean = Mean(x);
+  double sum = 0;
+  for (double v : x) sum += (v - mean) * (v - mean);
+  return sum / (x.size() - 1);
+}
+
+// median of the runs which found something, -1 if none did
+double MedianFound(std::vector<double> x) {
+  x.erase(std::remove_if(x.begin(), x.end(), [](double v) { return v < 0; }),
+          x.end());
+  if (x.empty()) return -1;
+  std::sort(x.begin(), x.end());
+  const int n = x.size();
+  return n % 2 ? x[n / 2] : (x[n / 2 - 1] + x[n / 2]) / 2;
+}
+
+// two-sided 95% quantile of the t-distribution with df degrees of freedom
+double TQuantile(double df) {
+  static const double kTable[30] = {
+      12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+      2.201,  2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+      2.080,  2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+  const int index = int(std::floor(df)) - 1;
+  if (index < 0) return kTable[0];
+  return index < 30 ? kTable[index] : 1.960;
+}
+
+// Welch's t-test: returns +1 (-1) if the mean of y is significantly larger
+// (smaller) than the mean of x, and 0 otherwise
+int WelchTest(const std::vector<double>& x, const std::vector<double>& y) {
+  if (x.size() < 2 || y.size() < 2) return 0;
+  const double vx = Variance(x) / x.size(), vy = Variance(y) / y.size();
+  const double diff = Mean(y) - Mean(x);
+  if (vx + vy == 0) return diff > 0 ? 1 : diff < 0 ? -1 : 0;
+  const double t = diff / std::sqrt(vx + vy);
+  const double df = (vx + vy) * (vx + vy) /
+                    (vx * vx / (x.size() - 1) + vy * vy / (y.size() - 1));
+  if (std::fabs(t) < TQuantile(df)) return 0;
+  return t > 0 ? 1 : -1;
+}
+
+// prints the relative change of the mean and returns the significance
+int Compare(const std::string& label, const std::vector<double>& base,
+            const std::vector<double>& current) {
+  const double mean_base = Mean(base), mean = Mean(current);
+  const int result = WelchTest(base, current);
+  std::cout << "  " << std::left << std::setw(20) << label << std::right
+            << std::setw(12) << mean_base << " -> " << std::setw(12) << mean;
+  if (mean_base != 0)
+    std::cout << std::showpos << std::setw(8) << std::fixed
+              << std::setprecision(1) << 100 * (mean - mean_base) / mean_base
+              << "%" << std::noshowpos;
+  std::cout.unsetf(std::ios::floatfield);
+  std::cout << std::setprecision(6);
+  std::cout << (result > 0 ? "  (significant increase)"
+                           : result < 0 ? "  (significant decrease)" : "")
+            << std::endl;
+  return result;
+}
+
+// runs nldtool with the given arguments, returns false if the search did not
+// end with its budget or produced no metrics
+bool RunSearch(const std::string& nldtool, std::vector<std::string> args,
+               const std::string& metrics_file, Measurements& m) {
+  std::remove(metrics_file.c_str());
+  args.insert(args.begin(), nldtool);
+  std::vector<char*> argv;
+  for (std::string& arg : args) argv.push_back(&arg[0]);
+  argv.push_back(nullptr);
+
+  pid_t pid = fork();
+  if (pid == -1) return false;
+  if (pid == 0) {
+    int null = open("/dev/null", O_WRONLY);
+    dup2(null, STDOUT_FILENO);
+    dup2(null, STDERR_FILENO);
+    execv(nldtool.c_str(), argv.data());
+    _exit(127);
+  }
+  int status;
+  struct rusage usage;
+  if (wait4(pid, &status, 0, &usage) != pid) return false;
+  // nldtool exits with 1 if the time or iteration budget is exhausted and with
+  // 0 if it ended after the first result
+  if (!WIFEXITED(status) || WEXITSTATUS(status) > 1) return false;
+
+  std::ifstream file(metrics_file);
+  std::string line, last;
+  while (std::getline(file, line))
+    if (!line.empty()) last = line;
+  std::remove(metrics_file.c_str());
+  double elapsed, iterations, restarts, first_found_time;
+  if (!ParseNumber(last, "elapsed", elapsed) ||
+      !ParseNumber(last, "global_iterations", iterations) ||
+      !ParseNumber(last, "restarts", restarts) ||
+      !ParseNumber(last, "first_found_time", first_found_time))
+    return false;
+  if (elapsed <= 0) elapsed = 1e-9;
+  m.iterations_per_sec.push_back(iterations / elapsed);
+  m.restarts_per_sec.push_back(restarts / elapsed);
+  m.first_found_time.push_back(first_found_time);
+  m.peak_rss_kb.push_back(usage.ru_maxrss);  // in kilobytes on Linux
+  return true;
+}
+
+void PrintSummary(const Measurements& m) {
+  int found = 0;
+  for (double t : m.first_found_time) found += t >= 0;
+  std::cout << std::left << std::setw(10) << m.name << std::right
+            << " iterations/sec: " << Mean(m.iterations_per_sec) << " +- "
+            << std::sqrt(Variance(m.iterations_per_sec))
+            << " restarts/sec: " << Mean(m.restarts_per_sec)
+            << " found: " << found << "/" << m.first_found_time.size()
+            << " median_first_found: " << MedianFound(m.first_found_time)
+            << " peak_rss_kb: " << Mean(m.peak_rss_kb) << std::endl;
+}
+
+std::string DefaultNldtool(const std::string& argv0) {
+  size_t pos = argv0.rfind('/');
+  return pos == std::string::npos ? "./nldtool"
+                                  : argv0.substr(0, pos + 1) + "nldtool";
+}
+
+int main(int argc, char* argv[]) {
+  try {
+    cxxopts::Options options(
+        argv[0],
+        "End-to-end search benchmark: runs nldtool on a fixed set of search "
+        "configurations with several seeds each and compares the throughput "
+        "against a baseline.");
+    options.add_options()                                                   //
+        ("h,help",                                                          //
+         "print help",                                                      //
+         cxxopts::value<bool>(),                                            //
+         "")                                                                //
+        ("o,output-file",                                                   //
+         "JSON file with the results",                                      //
+         cxxopts::value<std::string>()->default_value("nldsearchbench.json"),
+         "FILE")                                                            //
+        ("b,baseline",                                                      //
+         "JSON file of an earlier run to compare with",                     //
+         cxxopts::value<std::string>(),                                     //
+         "FILE")                                                            //
+        ("fail-on-regression",                                              //
+         "exit with an error if the iterations/sec decreased significantly",
+         cxxopts::value<bool>(),                                            //
+         "")                                                                //
+        ("c,config",                                                        //
+         "only run configurations matching the regular expression",        //
+         cxxopts::value<std::string>()->default_value("."),                 //
+         "REGEX")                                                           //
+        ("k,seeds",                                                         //
+         "number of seeds (runs) per configuration",                        //
+         cxxopts::value<int>()->default_value("5"),                         //
+         "K")                                                               //
+        ("R,random-seed",                                                   //
+         "first seed, the runs use SEED, SEED+1, ...",                      //
+         cxxopts::value<int64_t>()->default_value("1"),                     //
+         "SEED")                                                            //
+        ("e,end-time",                                                      //
+         "end each search after N seconds",                                 //
+         cxxopts::value<int>()->default_value("10"),                        //
+         "N")                                                               //
+        ("end-iterations",                                                  //
+         "end each search after N iterations",                              //
+         cxxopts::value<int64_t>()->default_value("-1"),                    //
+         "N")                                                               //
+        ("nldtool",                                                         //
+         "path of the nldtool binary (default: next to this binary)",       //
+         cxxopts::value<std::string>(),                                     //
+         "FILE")                                                            //
+        ("examples",                                                        //
+         "path of the examples folder",                                     //
+         cxxopts::value<std::string>()->default_value(NLDTOOL_EXAMPLES_DIR),
+         "DIR");
+    options.parse(argc, argv);
+
+    if (options.count("help")) {
+      std::cout << options.help({""}) << std::endl;
+      exit(0);
+    }
+
+    const std::string nldtool = options.count("nldtool")
+                                    ? options["nldtool"].as<std::string>()
+                                    : DefaultNldtool(argv[0]);
+    const std::string examples = options["examples"].as<std::string>();
+    const std::regex filter(options["config"].as<std::string>());
+    const int end_time = options["end-time"].as<int>();
+    const int64_t end_iterations = options["end-iterations"].as<int64_t>();
+    if (end_time == -1 && end_iterations == -1) {
+      std::cerr << "error: either an end time or an iteration budget is needed"
+                << std::endl;
+      exit(-1);
+    }
+    std::vector<int64_t> seeds;
+    for (int k = 0; k < options["seeds"].as<int>(); ++k)
+      seeds.push_back(options["random-seed"].as<int64_t>() + k);
+
+    std::map<std::string, Measurements> baseline;
+    if (options.count("baseline") &&
+        !ReadBaseline(options["baseline"].as<std::string>(), baseline)) {
+      std::cerr << "error: reading file '"
+                << options["baseline"].as<std::string>() << "'" << std::endl;
+      exit(-1);
+    }
+
+    std::vector<Measurements> results;
+    const std::string metrics_file =
+        options["output-file"].as<std::string>() + ".metrics";
+    for (const SearchConfig& config : kSearchConfigs) {
+      if (!std::regex_search(config.name, filter)) continue;
+      Measurements m;
+      m.name = config.name;
+      for (int64_t seed : seeds) {
+        // negative values have to be given as --option=value
+        std::vector<std::string> args = {
+            "-i", examples + "/" + config.file, "-R", std::to_string(seed),
+            "-M", metrics_file, "--print-info=-1",
+            "--end-time=" + std::to_string(end_time),
+            "--end-iterations=" + std::to_string(end_iterations)};
+        if (!RunSearch(nldtool, args, metrics_file, m)) {
+          std::cerr << "error: search " << config.name << " with seed " << seed
+                    << " failed (" << nldtool << ")" << std::endl;
+          exit(-1);
+        }
+      }
+      PrintSummary(m);
+      results.push_back(m);
+    }
+
+    std::ofstream file(options["output-file"].as<std::string>());
+    if (!file) {
+      std::cerr << "error: writing file '"
+                << options["output-file"].as<std::string>() << "'"
+                << std::endl;
+      exit(-1);
+    }
+    WriteJson(file, results, seeds, end_time, end_iterations);
+
+    bool regression = false;
+    for (const Measurements& m : results) {
+      auto base = baseline.find(m.name);
+      if (base == baseline.end()) continue;
+      std::cout << "Compare " << m.name << " with baseline:" << std::endl;
+      regression |= Compare("iterations/sec", base->second.iterations_per_sec,
+                             m.iterations_per_sec) < 0;
+      Compare("restarts/sec", base->second.restarts_per_sec,
+              m.restarts_per_sec);
+      Compare("peak_rss_kb", base->second.peak_rss_kb, m.peak_rss_kb);
+      std::cout << "  " << std::left << std::setw(20) << "median_first_found"
+                << std::right << std::setw(12)
+                << MedianFound(base->second.first_found_time) << " -> "
+                << std::setw(12) << MedianFound(m.first_found_time)
+                << std::endl;
+    }
+    if (regression && options.count("fail-on-regression")) exit(1);
+  } catch (const cxxopts::OptionException& e) {
+    std::cout << "error parsing options: " << e.what() << std::endl;
+    exit(-1);
+  }
+  return 0;
+}
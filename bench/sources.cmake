@@ -0,0 +1,39 @@
+set(NLDBENCH_FILES
+  bench/benchmark.cpp
+  bench/benchmark.h
+  bench/nldbench.cpp
+)
+
+set(NLDSEARCHBENCH_FILES
+  bench/searchbench.cpp
+)
+
+set(NLDALLOCCHECK_FILES
+  bench/alloccheck.cpp
+)
+
+set(NLDPROPCHECK_FILES
+  bench/propcheck.cpp
+)
+
+# add smoke test case for the benchmark driver
+add_test(_bench nldbench -b "^Loop/IF$" -t 0 -o nldbench.json)
+
+# check that the search loop does not allocate after the warm-up
+add_test(_alloccheck nldalloccheck -i ${CMAKE_SOURCE_DIR}/examples/md4/eurocryptWangLFCY05/start.xml -R 963821092 --print-info=-1)
+
+# check the direct propagation of the bitslice functions against the Loop
+add_test(_propcheck_add nldpropcheck -c "^ADDB?<")
+add_test(_propcheck_add4add2 nldpropcheck -c "^ADD4ADD2/")
+add_test(_propcheck_sadd nldpropcheck -c "^SADD/")
+add_test(_propcheck_add2u1u1rot nldpropcheck -c "^ADD2U1U1ROT/")
+add_test(_propcheck_xor nldpropcheck -c "^XORB?<")
+add_test(_propcheck_sbox nldpropcheck -c "^SBOX<")
+
+# add smoke test cases for the search benchmark driver (only MD4 for now)
+if(UNIX)
+  add_test(_searchbench nldsearchbench -c "^md4_wang$" -k 2 --end-iterations 2000 -o nldsearchbench.json)
+  add_test(_searchbench_compare nldsearchbench -c "^md4_wang$" -k 2 --end-iterations 2000 -o nldsearchbench2.json -b nldsearchbench.json)
+  set_tests_properties(_searchbench PROPERTIES FIXTURES_SETUP searchbench)
+  set_tests_properties(_searchbench_compare PROPERTIES FIXTURES_REQUIRED searchbench)
+endif()
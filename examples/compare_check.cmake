@@ -0,0 +1,19 @@
+# Runs "nldtool -i INPUT_FILE --check-char 2" once on the characteristic of
+# the XML file and once on the binary file BINARY_FILE, and fails if the
+# outputs differ.
+#
+# cmake -DNLDTOOL=... -DINPUT_FILE=... -DBINARY_FILE=... -P compare_check.cmake
+
+execute_process(COMMAND ${NLDTOOL} -i ${INPUT_FILE} --check-char 2
+  OUTPUT_VARIABLE TEXT_OUTPUT RESULT_VARIABLE TEXT_RESULT)
+execute_process(COMMAND ${NLDTOOL} -i ${INPUT_FILE} --check-char 2
+  --binary-input ${BINARY_FILE}
+  OUTPUT_VARIABLE BINARY_OUTPUT RESULT_VARIABLE BINARY_RESULT)
+
+if(NOT TEXT_RESULT EQUAL 0 OR NOT BINARY_RESULT EQUAL 0)
+  message(FATAL_ERROR "check failed (text: ${TEXT_RESULT}, binary: ${BINARY_RESULT})")
+endif()
+if(NOT TEXT_OUTPUT STREQUAL BINARY_OUTPUT)
+  message(FATAL_ERROR "binary characteristic differs from the text input\n"
+    "text:\n${TEXT_OUTPUT}\nbinary:\n${BINARY_OUTPUT}")
+endif()
@@ -1,27 +1,240 @@
+#include <algorithm>
+#include <cstdio>
 #include <fstream>
+#include <functional>
 #include <iomanip>
 #include <istream>
 #include <map>
+#include <memory>
+#include <string>
+#include <vector>
 
+#ifdef __unix__
+#include <glob.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "cache_manager.h"
 #include "crypto.h"
 #include "crypto_options.h"
 #include "cxxopts.hpp"
 #include "logfile.h"
+#include "service.h"
+#include "tool_options.h"
 #include "xml_config.h"
 
 constexpr auto version_string = "nldtool v1.0.0";
 
+std::unique_ptr<cxxopts::Options> CreateOptions(const char* program) {
+  std::unique_ptr<cxxopts::Options> options(
+      new cxxopts::Options(program,
+                           "Search for nonlinear differential "
+                           "characteristics in cryptographic "
+                           "algorithms."));
+  AddToolOptions(*options);
+  AddCryptoSpecificOptions(*options);
+  return options;
+}
+
 int CheckCharacteristic(XmlConfig& config) {
   Logfile logfile(config.GetOptions()["log-file"].as<std::string>());
   Characteristic characteristic = config.GenerateCharacteristic();
   int check_level = config.GetOptions()["check-char"].as<int>();
-  return characteristic.CheckCharacteristic(logfile, check_level, true);
+  int result = characteristic.CheckCharacteristic(logfile, check_level, true);
+#ifdef CACHE_STATISTICS
+  CacheManager::PrintStatistics(logfile.getStream());
+#endif
+  if (config.GetOptions().count("binary-output") &&
+      !characteristic.WriteBinary(
+          config.GetOptions()["binary-output"].as<std::string>()))
+    return -1;
+  return result;
+}
+
+// the results of a batch check besides the ones of CheckCharacteristic
+const int kBatchNotChecked = -2;
+const int kBatchError = -1;
+
+std::vector<std::string> ReadBatchFiles(const std::string& list_file) {
+  std::vector<std::string> files;
+  std::ifstream list(list_file);
+  if (!list) {
+    std::cout << "error: could not open " << list_file << std::endl;
+    exit(-1);
+  }
+  std::string line;
+  while (std::getline(list, line)) {
+    if (line.empty()) continue;
+#ifdef __unix__
+    glob_t matches;
+    if (glob(line.c_str(), GLOB_NOCHECK, nullptr, &matches) == 0)
+      files.insert(files.end(), matches.gl_pathv,
+                   matches.gl_pathv + matches.gl_pathc);
+    globfree(&matches);
+#else
+    files.push_back(line);
+#endif
+  }
+  return files;
+}
+
+int CheckBatchFile(int argc, char* argv[], const std::string& file,
+                   XmlConfig::CryptoPool& pool) {
+  // every file gets fresh options, since the options of an XML file are not
+  // overridden by the next one; the characteristic is only read if an input
+  // file is set, so the file is added as the last one
+  std::string input_file = "--input-file=" + file;
+  std::vector<char*> args(argv, argv + argc);
+  args.push_back(&input_file[0]);
+  int args_count = args.size();
+  char** args_ptr = args.data();
+  std::unique_ptr<cxxopts::Options> options = CreateOptions(argv[0]);
+  options->parse(args_count, args_ptr);
+  XmlConfig config(*options);
+  config.SetCryptoPool(&pool);
+  config.Load(file);
+  Logfile logfile((*options)["log-file"].as<std::string>());
+  logfile << "Info: check " << file << std::endl;
+  Characteristic characteristic = config.GenerateCharacteristic();
+  return characteristic.CheckCharacteristic(
+      logfile, (*options)["check-char"].as<int>(), false);
+}
+
+// checks the files one after the other, reusing the cryptos and the caches
+void CheckBatchFiles(int argc, char* argv[],
+                     const std::vector<std::string>& files,
+                     const std::vector<int>& indices, std::vector<int>& results,
+                     FILE* out) {
+  XmlConfig::CryptoPool pool;
+  for (int i : indices) {
+    results[i] = CheckBatchFile(argc, argv, files[i], pool);
+    if (out) {
+      fprintf(out, "%d %d\n", i, results[i]);
+      fflush(out);
+    }
+  }
+}
+
+#ifdef __unix__
+// checks the files of each list in a worker process, the caches are not
+// shared between threads; a file that makes its worker exit (like an invalid
+// XML file) is an error, the rest of the list is checked by a new worker
+void CheckBatchWorkers(int argc, char* argv[],
+                       const std::vector<std::string>& files,
+                       std::vector<std::vector<int>> lists,
+                       std::vector<int>& results) {
+  while (!lists.empty()) {
+    std::vector<std::pair<pid_t, FILE*>> workers;
+    for (const std::vector<int>& list : lists) {
+      int fds[2];
+      if (pipe(fds) != 0) {
+        std::cout << "error: could not create pipe" << std::endl;
+        exit(-1);
+      }
+      const pid_t pid = fork();
+      if (pid == 0) {
+        close(fds[0]);
+        // the output of the workers would interleave, only the summary is
+        // printed
+        if (!freopen("/dev/null", "w", stdout)) exit(-1);
+        FILE* out = fdopen(fds[1], "w");
+        CheckBatchFiles(argc, argv, files, list, results, out);
+        fclose(out);
+        exit(0);
+      }
+      close(fds[1]);
+      if (pid < 0) {
+        std::cout << "error: could not start worker" << std::endl;
+        exit(-1);
+      }
+      workers.push_back(std::make_pair(pid, fdopen(fds[0], "r")));
+    }
+    std::vector<std::vector<int>> remaining;
+    for (int w = 0; w < workers.size(); w++) {
+      int index, result;
+      while (fscanf(workers[w].second, "%d %d", &index, &result) == 2)
+        results[index] = result;
+      fclose(workers[w].second);
+      waitpid(workers[w].first, nullptr, 0);
+      const std::vector<int>& list = lists[w];
+      auto first = std::find_if(list.begin(), list.end(), [&](int i) {
+        return results[i] == kBatchNotChecked;
+      });
+      if (first == list.end()) continue;
+      results[*first] = kBatchError;
+      if (first + 1 != list.end())
+        remaining.emplace_back(first + 1, list.end());
+    }
+    lists.swap(remaining);
+  }
+}
+#endif
+
+int CheckBatch(int argc, char* argv[], const std::string& list_file,
+               int jobs) {
+  const std::vector<std::string> files = ReadBatchFiles(list_file);
+
+  // files with the same options share the crypto and the warm caches, so a
+  // group is checked by a single worker; the largest groups are assigned
+  // first, each to the worker with the fewest files
+  std::map<std::string, std::vector<int>> groups;
+  for (int i = 0; i < files.size(); i++)
+    groups[XmlConfig::GetOptionsKey(files[i])].push_back(i);
+  std::vector<const std::vector<int>*> sorted;
+  for (const auto& group : groups) sorted.push_back(&group.second);
+  std::stable_sort(sorted.begin(), sorted.end(),
+                   [](const std::vector<int>* a, const std::vector<int>* b) {
+                     return a->size() > b->size();
+                   });
+  std::vector<std::vector<int>> lists(std::max(jobs, 1));
+  for (const std::vector<int>* group : sorted) {
+    auto list = std::min_element(
+        lists.begin(), lists.end(),
+        [](const std::vector<int>& a, const std::vector<int>& b) {
+          return a.size() < b.size();
+        });
+    list->insert(list->end(), group->begin(), group->end());
+  }
+  lists.erase(std::remove_if(lists.begin(), lists.end(),
+                             [](const std::vector<int>& list) {
+                               return list.empty();
+                             }),
+              lists.end());
+
+  std::vector<int> results(files.size(), kBatchNotChecked);
+#ifdef __unix__
+  CheckBatchWorkers(argc, argv, files, lists, results);
+#else
+  for (const std::vector<int>& list : lists)
+    CheckBatchFiles(argc, argv, files, list, results, nullptr);
+#endif
+
+  int num_ok = 0, num_failed = 0, num_errors = 0;
+  for (int i = 0; i < files.size(); i++) {
+    std::cout << "Info: check-batch " << files[i] << ": ";
+    if (results[i] == kBatchError) {
+      std::cout << "error" << std::endl;
+      num_errors++;
+    } else if (results[i] != 0) {
+      std::cout << "failed (" << results[i] << ")" << std::endl;
+      num_failed++;
+    } else {
+      std::cout << "ok" << std::endl;
+      num_ok++;
+    }
+  }
+  std::cout << "Info: check-batch " << files.size() << " files, " << num_ok
+            << " ok, " << num_failed << " failed, " << num_errors << " errors"
+            << std::endl;
+  return num_ok == files.size() ? 0 : 1;
 }
 
 void ConfigSearch(XmlConfig& config) {
   Logfile logfile(config.GetOptions()["log-file"].as<std::string>());
   Characteristic characteristic = config.GenerateCharacteristic();
   if (characteristic.CheckCharacteristic(logfile, 2, true) != 0) {
+    logfile.Flush();
     std::cout << "error: initial characteristic check failed" << std::endl;
     exit(-1);
   }
@@ -30,128 +243,49 @@ void ConfigSearch(XmlConfig& config) {
                 config.GetOptions()["random-seed"].as<int64_t>());
   search.SetDumpTime(config.GetOptions()["dump-time"].as<int>());
   search.SetDumpCount(config.GetOptions()["dump-restarts"].as<int>());
+  search.SetSnapshotInterval(config.GetOptions()["dump-interval"].as<int>());
   config.PrintSearchConfig(logfile);
   config.PrintOptions(logfile);
   search.Start();
 }
 
+int RunTool(cxxopts::Options& options, std::vector<char*>& args,
+            XmlConfig::CryptoPool* pool,
+            const std::function<void()>& generated) {
+  if (options.count("check-batch"))
+    return CheckBatch(args.size(), args.data(),
+                      options["check-batch"].as<std::string>(),
+                      options["jobs"].as<int>());
+#ifdef __unix__
+  if (options.count("submit"))
+    return Submit(options["submit"].as<std::string>(), args);
+  if (options.count("serve"))
+    return Serve(options["serve"].as<std::string>(),
+                 std::max(options["jobs"].as<int>(), 1));
+#endif
+
+  XmlConfig config(options);
+  config.SetCryptoPool(pool);
+  if (!options["input-file"].as<std::string>().empty()) {
+    config.Load(options["input-file"].as<std::string>());
+    if (generated) {
+      config.GenerateCrypto();
+      generated();
+    }
+  }
+  if (options.count("probability"))
+    config.GetPrintConfig().SetFlag("probability", true);
+
+  if (options.count("check-char")) return CheckCharacteristic(config);
+
+  ConfigSearch(config);
+  return -1;
+}
+
 int main(int argc, char* argv[]) {
   try {
-    cxxopts::Options options(argv[0],
-                             "Search for nonlinear differential "
-                             "characteristics in cryptographic "
-                             "algorithms.");
-    options.add_options()                                                 //
-        ("h,help",                                                        //
-         "print help",                                                    //
-         cxxopts::value<bool>(),                                          //
-         "")                                                              //
-        ("v,version",                                                     //
-         "print version",                                                 //
-         cxxopts::value<bool>(),                                          //
-         "")                                                              //
-        ("i,input-file",                                                  //
-         "XML file with input characteristic and configurations",         //
-         cxxopts::value<std::string>(),                                   //
-         "FILE")                                                          //
-        ("l,log-file",                                                    //
-         "filename to write log output (in addition to stdout)",          //
-         cxxopts::value<std::string>(),                                   //
-         "FILE")                                                          //
-        ("c,check-char",                                                  //
-         "check characteristic with level L",                             //
-         cxxopts::value<int>()->default_value("2")->implicit_value("2"),  //
-         "L")                                                             //
-        ("s,start-round",                                                 //
-         "start round",                                                   //
-         cxxopts::value<int>()->default_value("0"),                       //
-         "N")                                                             //
-        ("n,num-rounds",                                                  //
-         "number of rounds",                                              //
-         cxxopts::value<int>()->default_value("1"),                       //
-         "N")                                                             //
-        ("b,blocks",                                                      //
-         "number of message blocks",                                      //
-         cxxopts::value<int>()->default_value("1"),                       //
-         "N")                                                             //
-        ("r,rate",                                                        //
-         "rate of a sponge function",                                     //
-         cxxopts::value<int>()->default_value("64"),                      //
-         "N");
-
-    options.add_options("Print")                                       //
-        ("P,print-config",                                             //
-         "XML file with print configuration",                          //
-         cxxopts::value<std::string>()->default_value(                 //
-             "examples/print_config.xml"),                             //
-         "FILE")                                                       //
-        ("I,print-info",                                               //
-         "print info at every restart and in 2 * N second intervals",  //
-         cxxopts::value<int>()->default_value("1"),                    //
-         "N")                                                          //
-        ("C,print-char",                                               //
-         "print characteristic interval in seconds",                   //
-         cxxopts::value<int>()->default_value("-1"),                   //
-         "N")                                                          //
-        ("Z,print-steps",                                              //
-         "print main or all steps",                                    //
-         cxxopts::value<std::string>()->default_value("main"),         //
-         "(main|all)")                                                 //
-        ("p,probability",                                              //
-         "compute and print the differential probability",             //
-         cxxopts::value<bool>(),                                       //
-         "")                                                           //
-        ("m,minfree-threshold",                                        //
-         "threshold to start printing minfree characteristics",        //
-         cxxopts::value<int>()->default_value("200"),                  //
-         "N");
-
-    options.add_options("Search")                                 //
-        ("S,search-config",                                       //
-         "XML file with search configuration",                    //
-         cxxopts::value<std::string>(),                           //
-         "FILE")                                                  //
-        ("R,random-seed",                                         //
-         "random seed",                                           //
-         cxxopts::value<int64_t>()->default_value("-1"),          //
-         "SEED")                                                  //
-        ("e,end-time",                                            //
-         "end search after N seconds",                            //
-         cxxopts::value<int>()->default_value("-1"),              //
-         "N")                                                     //
-        ("E,end-found",                                           //
-         "end search once first result has been found",           //
-         cxxopts::value<bool>(),                                  //
-         "")                                                      //
-        ("F,stack-frequency",                                     //
-         "after N guesses, the whole state is put on the stack",  //
-         cxxopts::value<int>()->default_value("100"),             //
-         "N")                                                     //
-        ("d,dump-time",                                           //
-         "generate dump after N hours and quit program",          //
-         cxxopts::value<int>()->default_value("-1"),              //
-         "N")                                                     //
-        ("D,dump-restarts",                                       //
-         "generate dump after N restarts and quit program",       //
-         cxxopts::value<int>()->default_value("-1"),              //
-         "N");
-
-    options.add_options("XML")                                  //
-        ("w,word-size",                                         //
-         "word size",                                           //
-         cxxopts::value<int>()->default_value("32"),            //
-         "N")                                                   //
-        ("z,read-steps",                                        //
-         "read main or all steps",                              //
-         cxxopts::value<std::string>()->default_value("main"),  //
-         "(main|all)")                                          //
-        ("f,function",                                          //
-         "cryptographic function to analyze",                   //
-         cxxopts::value<std::string>(),                         //
-         "F");
-
-    options.parse_positional("input-file");
-    AddCryptoSpecificOptions(options);
+    std::unique_ptr<cxxopts::Options> options_ptr = CreateOptions(argv[0]);
+    cxxopts::Options& options = *options_ptr;
 
     // sort the help output so that crypto-specific options are at the end
     std::vector<std::string> general_groups = {"", "Search", "Print", "XML"};
@@ -167,6 +301,8 @@ int main(int argc, char* argv[]) {
       std::cout << options.help(sorted_groups) << std::endl;
       exit(-1);
     }
+    // parsing removes the parsed arguments, the workers parse them again
+    std::vector<char*> args(argv, argv + argc);
     options.parse(argc, argv);
 
     if (options.count("help")) {
@@ -178,18 +314,7 @@ int main(int argc, char* argv[]) {
       exit(0);
     }
 
-    XmlConfig config(options);
-    if (!options["input-file"].as<std::string>().empty())
-      config.Load(options["input-file"].as<std::string>());
-    if (options.count("probability"))
-      config.GetPrintConfig().SetFlag("probability", true);
-
-    if (options.count("check-char")) {
-      int result = CheckCharacteristic(config);
-      exit(result);
-    }
-
-    ConfigSearch(config);
+    exit(RunTool(options, args, nullptr));
 
   } catch (const cxxopts::OptionException& e) {
     std::cout << "error parsing options: " << e.what() << std::endl;
@@ -25,31 +25,6 @@ const int Md5::S[64] = {7,  12, 17, 22, 7,  12, 17, 22, 7,  12, 17, 22, 7,
 const int Md5::H = 4;
 const int Md5::L = 7;
 
-class Md5::ADD4ADD2 : public F {
- public:
-  static constexpr char kName[] = "ADD4ADD2";
-  static const int kNumInputs = 6;
-  static const int kNumOutputs = 3;
-  static const int kPrevState = 5;
-  static const int kNextState = 8;
-  static const int kStateSize = 64;
-  static constexpr int Symmetry(int i) { return (i < 4) ? 0 : i; }
-  static constexpr int Bitsize(int i) { return (i == 5 || i == 8) ? 3 : 1; }
-  template <class T>
-  static void f(const T x[kNumInputs], T y[kNumOutputs]) {
-    const int ci = kNumInputs - 1;
-    const int sb = 0;
-    const int sa = 1;
-    const int co = 2;
-    y[sb] = x[0] + x[1] + x[2] + x[3] + (x[ci] % 4);
-    y[co] = y[sb] >> 1;
-    y[sb] &= 1;
-    y[sa] = y[sb] + x[4] + (x[ci] / 4);
-    y[co] |= (y[sa] >> 1) * 4;
-    y[sa] &= 1;
-  }
-};
-
 constexpr char Md5::ADD4ADD2::kName[];
 
 void Md5::AddToOptions(cxxopts::Options& options) {}
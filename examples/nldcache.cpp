@@ -0,0 +1,166 @@
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "cache_manager.h"
+#include "characteristic.h"
+#include "crypto_options.h"
+#include "cxxopts.hpp"
+#include "logfile.h"
+#include "tool_options.h"
+#include "xml_config.h"
+
+namespace {
+
+std::unique_ptr<cxxopts::Options> ParseOptions(int argc, char* argv[]) {
+  std::unique_ptr<cxxopts::Options> options(new cxxopts::Options(
+      argv[0],
+      "Merge, pre-warm and inspect the cache dumps of nldtool in caches/."));
+  AddToolOptions(*options);
+  AddCryptoSpecificOptions(*options);
+  options->add_options("Cache")                                            //
+      ("files",                                                            //
+       "text FILE with more XML files to load, one per line",              //
+       cxxopts::value<std::string>(),                                      //
+       "FILE")                                                             //
+      ("merge",                                                            //
+       "text FILE with dump directories of other runs, one per line",      //
+       cxxopts::value<std::string>(),                                      //
+       "FILE")                                                             //
+      ("replay",                                                           //
+       "check the characteristics to fill the caches (see check-char)",    //
+       cxxopts::value<bool>(),                                             //
+       "")                                                                 //
+      ("coverage",                                                         //
+       "print the entries of every cache, from the dumps and the replay",  //
+       cxxopts::value<bool>(),                                             //
+       "")                                                                 //
+      ("write",                                                            //
+       "write the caches to their dumps in caches/",                       //
+       cxxopts::value<bool>(),                                             //
+       "");
+  options->parse(argc, argv);
+  return options;
+}
+
+std::vector<std::string> ReadLines(const std::string& file_name) {
+  std::vector<std::string> lines;
+  std::ifstream file(file_name);
+  if (!file) {
+    std::cerr << "error: could not open " << file_name << std::endl;
+    exit(-1);
+  }
+  std::string line;
+  while (std::getline(file, line))
+    if (!line.empty()) lines.push_back(line);
+  return lines;
+}
+
+// the number of entries of a cache at the different stages
+struct Coverage {
+  ManagableCache* cache = nullptr;
+  int64_t initial = 0;
+  int64_t merged = 0;
+  int64_t replayed = 0;
+};
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  try {
+    if (argc <= 1) {
+      std::cout << ParseOptions(1, argv)->help() << std::endl;
+      exit(-1);
+    }
+    std::unique_ptr<cxxopts::Options> options = ParseOptions(argc, argv);
+    if (options->count("help")) {
+      std::cout << options->help() << std::endl;
+      exit(0);
+    }
+
+    std::vector<std::string> files;
+    if (!(*options)["input-file"].as<std::string>().empty())
+      files.push_back((*options)["input-file"].as<std::string>());
+    if (options->count("files")) {
+      std::vector<std::string> lines =
+          ReadLines((*options)["files"].as<std::string>());
+      files.insert(files.end(), lines.begin(), lines.end());
+    }
+    if (files.empty()) {
+      std::cerr << "error: no XML file given, they select the caches"
+                << std::endl;
+      exit(-1);
+    }
+    std::vector<std::string> merge_dirs;
+    if (options->count("merge"))
+      merge_dirs = ReadLines((*options)["merge"].as<std::string>());
+
+    // the caches are static, so they are shared by the cryptos of all files;
+    // every file gets fresh options, since the options of an XML file are not
+    // overridden by the next one
+    std::vector<Coverage> coverage;
+    std::set<ManagableCache*> seen;
+    int failed = 0;
+    for (const std::string& file : files) {
+      // the characteristic is only read if an input file is set, so the file
+      // is added as the last one
+      std::string input_file = "--input-file=" + file;
+      std::vector<char*> args(argv, argv + argc);
+      args.push_back(&input_file[0]);
+      std::unique_ptr<cxxopts::Options> file_options =
+          ParseOptions(args.size(), args.data());
+      XmlConfig config(*file_options);
+      config.Load(file);
+      Characteristic characteristic = config.GenerateCharacteristic();
+
+      // the dumps are loaded when a cache is used for the first time
+      for (ManagableCache* cache : CacheManager::GetCaches()) {
+        if (!cache->GetDumpFilepath() || !seen.insert(cache).second) continue;
+        coverage.push_back(Coverage());
+        Coverage& c = coverage.back();
+        c.cache = cache;
+        c.initial = cache->GetSize();
+        const std::string path = cache->GetDumpFilepath();
+        const std::string name = path.substr(path.find('/') + 1);
+        for (const std::string& dir : merge_dirs)
+          cache->MergeDump((dir + "/" + name).c_str());
+        c.merged = cache->GetSize();
+      }
+
+      if (options->count("replay")) {
+        Logfile logfile((*file_options)["log-file"].as<std::string>());
+        const int result = characteristic.CheckCharacteristic(
+            logfile, (*file_options)["check-char"].as<int>(), false);
+        logfile << "Info: replay " << file << ": "
+                << (result ? "failed" : "ok") << std::endl;
+        failed += result != 0;
+      }
+    }
+
+    // caches with entries of variable size can not be dumped, like in nldtool
+    for (Coverage& c : coverage) {
+      c.replayed = c.cache->GetSize();
+      if (options->count("write") && !c.cache->SaveDump())
+        std::cerr << "warning: writing " << c.cache->GetDumpFilepath()
+                  << " failed" << std::endl;
+    }
+
+    if (options->count("coverage")) {
+      for (const Coverage& c : coverage) {
+        std::cout << "Cache: " << c.cache->GetName();
+        std::cout << " initial: " << c.initial;
+        std::cout << " merged: " << c.merged - c.initial;
+        std::cout << " replayed: " << c.replayed - c.merged;
+        std::cout << " size: " << c.replayed << std::endl;
+      }
+    }
+    exit(failed ? 1 : 0);
+
+  } catch (const cxxopts::OptionException& e) {
+    std::cout << "error parsing options: " << e.what() << std::endl;
+    exit(-1);
+  }
+}
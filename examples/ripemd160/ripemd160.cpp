@@ -38,28 +38,6 @@ const int Ripemd160::XB[80] = {
 const int Ripemd160::H = 5;
 const int Ripemd160::L = 6;
 
-class Ripemd160::ADD4ADD2 : public F {
- public:
-  static constexpr char kName[] = "ADD4ADD2";
-  static const int kNumInputs = 6;
-  static const int kNumOutputs = 3;
-  static constexpr int Symmetry(int i) { return (i < 4) ? 0 : i; }
-  static constexpr int Bitsize(int i) { return (i == 5 || i == 8) ? 3 : 1; }
-  template <class T>
-  static void f(const T x[kNumInputs], T y[kNumOutputs]) {
-    const int ci = kNumInputs - 1;
-    const int sb = 0;
-    const int sa = 1;
-    const int co = 2;
-    y[sb] = x[0] + x[1] + x[2] + x[3] + ((x[ci] >> 1) & 3);
-    y[co] = y[sb] & 6;
-    y[sb] &= 1;
-    y[sa] = y[sb] + x[4] + (x[ci] & 1);
-    y[co] |= y[sa] >> 1;
-    y[sa] &= 1;
-  }
-};
-
 constexpr char Ripemd160::ADD4ADD2::kName[];
 
 class Ripemd160::XOR3ADD4ADD2 : public F {
@@ -1,7 +1,9 @@
 #ifndef RIPEMD160_H_
 #define RIPEMD160_H_
 
+#include "carry_automaton.h"
 #include "crypto.h"
+#include "functions.h"
 
 /*! \class Ripemd160
  *  \brief Implementation of the crypto function RIPEMD-160
@@ -51,4 +53,49 @@ class Ripemd160 : public Crypto {
   ConditionWordPtr CBi[80];
 };
 
+class Ripemd160::ADD4ADD2 : public F {
+ public:
+  static constexpr char kName[] = "ADD4ADD2";
+  static const int kNumInputs = 6;
+  static const int kNumOutputs = 3;
+  static constexpr int Symmetry(int i) { return (i < 4) ? 0 : i; }
+  static constexpr int Bitsize(int i) { return (i == 5 || i == 8) ? 3 : 1; }
+  template <class T>
+  static void f(const T x[kNumInputs], T y[kNumOutputs]) {
+    const int ci = kNumInputs - 1;
+    const int sb = 0;
+    const int sa = 1;
+    const int co = 2;
+    y[sb] = x[0] + x[1] + x[2] + x[3] + ((x[ci] >> 1) & 3);
+    y[co] = y[sb] & 6;
+    y[sb] &= 1;
+    y[sa] = y[sb] + x[4] + (x[ci] & 1);
+    y[co] |= y[sa] >> 1;
+    y[sa] &= 1;
+  }
+};
+
+// the second sum adds the sum bit of the first one
+template <>
+struct CarrySums<Ripemd160::ADD4ADD2> {
+  static const bool kEnabled = true;
+  static const int kNumSums = 2;
+  static constexpr void Add(int i, int x, int sums[]) {
+    if (i < 4) {
+      sums[0] += x;
+    } else if (i == 4) {
+      sums[1] += x;
+    } else {
+      sums[0] += (x >> 1) & 3;
+      sums[1] += x & 1;
+    }
+  }
+  static constexpr void Outputs(const int sums[], int y[]) {
+    const int sa = (sums[0] & 1) + sums[1];
+    y[0] = sums[0] & 1;
+    y[1] = sa & 1;
+    y[2] = (sums[0] & 6) | (sa >> 1);
+  }
+};
+
 #endif  // RIPEMD160_H_
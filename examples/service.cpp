@@ -0,0 +1,568 @@
+#include "service.h"
+
+#ifdef __unix__
+#include <cerrno>
+#include <climits>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <map>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+// the last line of the output of a job of the service
+constexpr auto exit_status_prefix = "Info: exit status ";
+
+// a longer request is invalid
+constexpr size_t max_request_size = 1 << 20;
+
+bool WriteAll(int fd, const std::string& data) {
+  size_t done = 0;
+  while (done < data.size()) {
+    const ssize_t n = write(fd, data.data() + done, data.size() - done);
+    if (n <= 0) return false;
+    done += n;
+  }
+  return true;
+}
+
+int OpenSocket(const std::string& path, bool listen_on_it) {
+  sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(addr.sun_path)) {
+    std::cout << "error: socket path " << path << " is too long" << std::endl;
+    exit(-1);
+  }
+  strcpy(addr.sun_path, path.c_str());
+  const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) return -1;
+  if (listen_on_it) {
+    unlink(path.c_str());
+    // a job runs with the rights of the service, so only its user may
+    // connect
+    const mode_t mask = umask(077);
+    const int bound = bind(fd, (sockaddr*)&addr, sizeof(addr));
+    umask(mask);
+    if (bound != 0 || listen(fd, 16) != 0) return -1;
+  } else if (connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+    return -1;
+  }
+  return fd;
+}
+
+// true if the client on the socket runs as the user of the service
+bool IsOwnClient(int fd) {
+#ifdef SO_PEERCRED
+  ucred cred;
+  socklen_t size = sizeof(cred);
+  return getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &size) == 0 &&
+         cred.uid == geteuid();
+#else
+  // the permissions of the socket still restrict it to the user
+  return true;
+#endif
+}
+
+/*!
+ * \brief A job of the service: the working directory of the client, followed
+ * by its arguments.
+ *
+ * A request has these strings terminated by '\0' and ends with an empty one.
+ */
+struct Job {
+  std::vector<std::string> request;
+  int fd = -1;
+  // the parsed options besides the input file, the jobs with the same key
+  // share a pool process
+  std::string key;
+  std::string input_file;
+};
+
+// the size of the request at the start of bytes, 0 if it is not complete
+size_t GetRequestSize(const std::string& bytes) {
+  for (size_t i = 0; i < bytes.size(); i++)
+    if (!bytes[i] && (i == 0 || !bytes[i - 1])) return i + 1;
+  return 0;
+}
+
+bool DecodeJob(const std::string& bytes, Job& job) {
+  size_t begin = 0;
+  size_t end;
+  while ((end = bytes.find('\0', begin)) != std::string::npos && end > begin) {
+    job.request.push_back(bytes.substr(begin, end - begin));
+    begin = end + 1;
+  }
+  return job.request.size() >= 2;
+}
+
+// reads the request byte by byte, the data after it is the next job
+bool ReadJob(int fd, Job& job) {
+  std::string bytes;
+  char c;
+  while (read(fd, &c, 1) == 1) {
+    bytes += c;
+    if (GetRequestSize(bytes)) return DecodeJob(bytes, job);
+  }
+  return false;
+}
+
+std::string EncodeJob(const Job& job) {
+  std::string request;
+  for (const std::string& s : job.request) request += s + '\0';
+  return request + '\0';
+}
+
+std::unique_ptr<cxxopts::Options> ParseJob(Job& job,
+                                           std::vector<char*>& args) {
+  args.clear();
+  for (int i = 1; i < job.request.size(); i++)
+    args.push_back(&job.request[i][0]);
+  std::vector<char*> parsed = args;
+  int argc = parsed.size();
+  char** argv = parsed.data();
+  std::unique_ptr<cxxopts::Options> options = CreateOptions(argv[0]);
+  options->parse(argc, argv);
+  return options;
+}
+
+// runs in the process of the job, with the output going to the client; a byte
+// on ready tells the pool process that the crypto of the job was generated
+int RunJob(Job& job, XmlConfig::CryptoPool& pool, int ready) {
+  if (chdir(job.request[0].c_str()) != 0) {
+    std::cout << "error: could not change to " << job.request[0] << std::endl;
+    return -1;
+  }
+  try {
+    std::vector<char*> args;
+    std::unique_ptr<cxxopts::Options> options = ParseJob(job, args);
+    if (options->count("serve") || options->count("submit")) {
+      std::cout << "error: a job can not use the service" << std::endl;
+      return -1;
+    }
+    return RunTool(*options, args, &pool, [ready]() {
+      if (ready >= 0) WriteAll(ready, std::string(1, '\0'));
+    });
+  } catch (const cxxopts::OptionException& e) {
+    std::cout << "error parsing options: " << e.what() << std::endl;
+    return -1;
+  }
+}
+
+// the key of a job holds the parsed values of all options that it sets,
+// besides the input file; an argument that only looks like an option (like a
+// negative value) is not set and left out
+bool GetJobKey(Job& job) {
+  std::vector<char*> args;
+  std::unique_ptr<cxxopts::Options> options;
+  try {
+    options = ParseJob(job, args);
+  } catch (const cxxopts::OptionException& e) {
+    return false;
+  }
+  job.input_file = (*options)["input-file"].as<std::string>();
+  const cxxopts::OptionDetails* input_file = &(*options)["input-file"];
+  std::map<std::string, std::string> values;
+  for (int i = 1; i < args.size(); i++) {
+    const std::string arg = args[i];
+    if (arg.size() < 2 || arg[0] != '-') continue;
+    const std::string name =
+        arg[1] == '-' ? arg.substr(2, arg.find('=') - 2) : arg.substr(1, 1);
+    if (!options->count(name) || &(*options)[name] == input_file) continue;
+    values[name] = (*options)[name].as<std::string>();
+  }
+  job.key.clear();
+  for (const auto& value : values)
+    job.key += value.first + '=' + value.second + '\n';
+  return true;
+}
+
+// true if the pool has the crypto of the job (or the job has no input file)
+bool IsWarm(const Job& job, const XmlConfig::CryptoPool& pool) {
+  if (job.input_file.empty()) return true;
+  const std::string file = job.input_file[0] == '/'
+                               ? job.input_file
+                               : job.request[0] + "/" + job.input_file;
+  return pool.count(XmlConfig::GetOptionsKey(file)) > 0;
+}
+
+// loads the XML file of a job like the job does, which generates its crypto
+// into the pool, initializes the static caches and loads the cache dumps
+void LoadJobCrypto(Job& job, XmlConfig::CryptoPool& pool) {
+  char cwd[PATH_MAX];
+  if (!getcwd(cwd, sizeof(cwd)) || chdir(job.request[0].c_str()) != 0) return;
+  std::vector<char*> args;
+  std::unique_ptr<cxxopts::Options> options = ParseJob(job, args);
+  XmlConfig config(*options);
+  config.SetCryptoPool(&pool);
+  config.Load(job.input_file);
+  config.GenerateCrypto();
+  if (chdir(cwd) != 0) exit(-1);
+}
+
+// keeps the crypto of a job in the pool process, so that the next jobs with
+// the same configuration start with it and with warm caches; an invalid
+// configuration exits, so this is only called after the job generated it
+void WarmUp(Job& job, XmlConfig::CryptoPool& pool) {
+  if (IsWarm(job, pool)) return;
+  // the XML file is printed while loading, the log only gets the job
+  std::cout << std::flush;
+  const int out = dup(1);
+  const int null = open("/dev/null", O_WRONLY);
+  dup2(null, 1);
+  LoadJobCrypto(job, pool);
+  std::cout << std::flush;
+  dup2(out, 1);
+  close(null);
+  close(out);
+  std::cout << "Info: keeping the crypto for " << job.input_file << std::endl;
+}
+
+// hands a job with its client to a pool process: the client socket goes with
+// a single byte, followed by the request
+bool SendJob(int fd, const Job& job) {
+  char byte = 0;
+  iovec iov = {&byte, 1};
+  char control[CMSG_SPACE(sizeof(int))];
+  memset(control, 0, sizeof(control));
+  msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+  cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+  memcpy(CMSG_DATA(cmsg), &job.fd, sizeof(int));
+  return sendmsg(fd, &msg, 0) == 1 && WriteAll(fd, EncodeJob(job));
+}
+
+bool ReceiveJob(int fd, Job& job) {
+  char byte;
+  iovec iov = {&byte, 1};
+  char control[CMSG_SPACE(sizeof(int))];
+  msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+  if (recvmsg(fd, &msg, 0) != 1) return false;
+  cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  if (!cmsg || cmsg->cmsg_type != SCM_RIGHTS) return false;
+  memcpy(&job.fd, CMSG_DATA(cmsg), sizeof(int));
+  return ReadJob(fd, job) && GetJobKey(job);
+}
+
+// wakes up a pool process when a job exits
+int child_exited_fd = -1;
+
+void ChildExited(int) {
+  const char c = 0;
+  if (write(child_exited_fd, &c, 1) < 0) return;
+}
+
+/*!
+ * \brief Runs the jobs of one configuration that the service sends on fd.
+ *
+ * Each job runs in its own process forked from the pool process, so it
+ * starts with the cryptos and the caches of the pool. When the first job has
+ * generated its crypto, it tells the pool process on a pipe, which then
+ * generates it once as well; this also initializes the static caches and
+ * loads the dumps. Only the jobs of this configuration wait for it. A job
+ * with an invalid configuration exits before, and the next job tries again.
+ * A byte goes back to the service for every finished job. The pool process
+ * exits when the service is gone and its jobs are finished.
+ */
+void RunPool(int fd) {
+  int child_exited[2];
+  if (pipe(child_exited) != 0) exit(-1);
+  fcntl(child_exited[1], F_SETFL, O_NONBLOCK);
+  child_exited_fd = child_exited[1];
+  signal(SIGCHLD, ChildExited);
+  XmlConfig::CryptoPool pool;
+  std::map<pid_t, int> running;
+  // the jobs that the pool waits for to generate their crypto, by the read
+  // end of their pipe
+  std::map<int, Job> warming;
+  bool open = true;
+  while (open || !running.empty()) {
+    int status;
+    pid_t pid;
+    while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+      if (!running.count(pid)) continue;
+      const int result = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+      WriteAll(running[pid],
+               exit_status_prefix + std::to_string(result) + "\n");
+      close(running[pid]);
+      running.erase(pid);
+      std::cout << "Info: job " << pid << " exit status " << result
+                << std::endl;
+      if (open && !WriteAll(fd, std::string(1, '\0'))) open = false;
+    }
+
+    std::vector<pollfd> pfds;
+    pfds.push_back(pollfd{open ? fd : -1, POLLIN, 0});
+    pfds.push_back(pollfd{child_exited[0], POLLIN, 0});
+    for (const auto& job : warming)
+      pfds.push_back(pollfd{job.first, POLLIN, 0});
+    if (poll(pfds.data(), pfds.size(), -1) <= 0) continue;
+    if (pfds[1].revents) {
+      char buffer[64];
+      if (read(child_exited[0], buffer, sizeof(buffer)) < 0) continue;
+    }
+    for (int i = 2; i < pfds.size(); i++) {
+      if (!pfds[i].revents) continue;
+      char generated;
+      const bool valid = read(pfds[i].fd, &generated, 1) == 1;
+      close(pfds[i].fd);
+      if (valid) WarmUp(warming[pfds[i].fd], pool);
+      warming.erase(pfds[i].fd);
+    }
+    if (!pfds[0].revents) continue;
+    Job job;
+    if (!ReceiveJob(fd, job)) {
+      if (job.fd >= 0) close(job.fd);
+      open = false;
+      continue;
+    }
+    int ready[2] = {-1, -1};
+    if (!IsWarm(job, pool) && pipe(ready) != 0) ready[0] = ready[1] = -1;
+    std::cout << std::flush;
+    pid = fork();
+    if (pid == 0) {
+      // the clients of the other jobs wait for the end of their output
+      for (const auto& other : running) close(other.second);
+      for (const auto& other : warming) close(other.first);
+      if (ready[0] >= 0) close(ready[0]);
+      close(fd);
+      close(child_exited[0]);
+      close(child_exited[1]);
+      signal(SIGPIPE, SIG_DFL);
+      signal(SIGCHLD, SIG_DFL);
+      dup2(job.fd, 1);
+      dup2(job.fd, 2);
+      exit(RunJob(job, pool, ready[1]));
+    }
+    if (ready[1] >= 0) close(ready[1]);
+    if (pid < 0) {
+      if (ready[0] >= 0) close(ready[0]);
+      WriteAll(job.fd, exit_status_prefix + std::to_string(255) + "\n");
+      close(job.fd);
+      if (!WriteAll(fd, std::string(1, '\0'))) open = false;
+      continue;
+    }
+    std::cout << "Info: job " << pid << " " << job.input_file << std::endl;
+    running[pid] = job.fd;
+    if (ready[0] >= 0) warming[ready[0]] = job;
+  }
+  exit(0);
+}
+
+// a pool process and the number of its jobs that are not finished
+struct Pool {
+  pid_t pid = -1;
+  int fd = -1;
+  int running = 0;
+};
+
+/*!
+ * \brief The state of the service: its socket, the clients that are still
+ * sending their request and the pool processes by the key of their jobs.
+ */
+struct Service {
+  int server = -1;
+  // the clients are not blocking, so that a slow one does not stop the
+  // service; the bytes of their request so far
+  std::map<int, std::string> clients;
+  std::map<std::string, Pool> pools;
+  int running = 0;
+};
+
+// hands the job with its client to the pool process of its configuration,
+// which is forked from the service for the first job with these options
+void StartJob(Service& service, Job& job) {
+  if (!service.pools.count(job.key)) {
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+      close(job.fd);
+      return;
+    }
+    std::cout << std::flush;
+    const pid_t pid = fork();
+    if (pid == 0) {
+      close(service.server);
+      close(fds[0]);
+      for (const auto& client : service.clients) close(client.first);
+      for (const auto& pool : service.pools) close(pool.second.fd);
+      close(job.fd);
+      RunPool(fds[1]);
+    }
+    close(fds[1]);
+    if (pid < 0) {
+      close(fds[0]);
+      close(job.fd);
+      return;
+    }
+    std::cout << "Info: pool " << pid << " for " << job.input_file
+              << std::endl;
+    service.pools[job.key].pid = pid;
+    service.pools[job.key].fd = fds[0];
+  }
+  Pool& pool = service.pools[job.key];
+  if (SendJob(pool.fd, job)) {
+    pool.running++;
+    service.running++;
+  } else {
+    WriteAll(job.fd, "error: could not start the job\n");
+    WriteAll(job.fd, exit_status_prefix + std::to_string(255) + "\n");
+  }
+  close(job.fd);
+}
+
+// reads what the client sent and starts its job when the request is complete
+void ReadClient(Service& service, int fd) {
+  char buffer[4096];
+  const ssize_t n = read(fd, buffer, sizeof(buffer));
+  if (n < 0 && (errno == EAGAIN || errno == EINTR)) return;
+  if (n <= 0) {
+    close(fd);
+    service.clients.erase(fd);
+    return;
+  }
+  std::string& bytes = service.clients[fd];
+  bytes.append(buffer, n);
+  const size_t size = GetRequestSize(bytes);
+  if (!size && bytes.size() < max_request_size) return;
+  Job job;
+  job.fd = fd;
+  const bool valid = size && DecodeJob(bytes.substr(0, size), job);
+  service.clients.erase(fd);
+  // the job writes its output to the client and waits for it
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+  if (!valid || !GetJobKey(job)) {
+    WriteAll(fd, "error: invalid job\n");
+    WriteAll(fd, exit_status_prefix + std::to_string(255) + "\n");
+    close(fd);
+    return;
+  }
+  StartJob(service, job);
+}
+
+}  // namespace
+
+/*!
+ * The service only accepts the jobs and hands each one with its client to the
+ * pool process of its configuration (see RunPool). The jobs start with the
+ * crypto, the static caches and the cache dumps that the pool process loaded.
+ * The entries that the jobs add to the dynamic caches are not shared: they
+ * stay in the process of the job and are lost when it exits, unless the job
+ * writes them to the dumps (--dump-interval), which only new pool processes
+ * load.
+ */
+int Serve(const std::string& path, int jobs) {
+  Service service;
+  service.server = OpenSocket(path, true);
+  if (service.server < 0) {
+    std::cout << "error: could not listen on " << path << std::endl;
+    return -1;
+  }
+  // a client or pool process that is gone must not stop the service
+  signal(SIGPIPE, SIG_IGN);
+  std::cout << "Info: serving on " << path << std::endl;
+  while (true) {
+    // the pool processes that exited are noticed on their sockets
+    while (waitpid(-1, nullptr, WNOHANG) > 0) {
+    }
+
+    // new jobs wait in the socket and the clients while all workers are busy
+    const bool idle = service.running < jobs;
+    std::vector<pollfd> pfds;
+    pfds.push_back(pollfd{idle ? service.server : -1, POLLIN, 0});
+    std::vector<std::string> keys;
+    for (const auto& pool : service.pools) {
+      pfds.push_back(pollfd{pool.second.fd, POLLIN, 0});
+      keys.push_back(pool.first);
+    }
+    for (const auto& client : service.clients)
+      pfds.push_back(pollfd{idle ? client.first : -1, POLLIN, 0});
+    if (poll(pfds.data(), pfds.size(), -1) <= 0) continue;
+    for (int i = 1; i <= keys.size(); i++) {
+      if (!pfds[i].revents) continue;
+      Pool& pool = service.pools[keys[i - 1]];
+      char finished[64];
+      const ssize_t n = read(pool.fd, finished, sizeof(finished));
+      if (n > 0) {
+        pool.running -= n;
+        service.running -= n;
+        continue;
+      }
+      std::cout << "Info: pool " << pool.pid << " exited" << std::endl;
+      service.running -= pool.running;
+      close(pool.fd);
+      service.pools.erase(keys[i - 1]);
+    }
+    for (int i = keys.size() + 1; i < pfds.size(); i++)
+      if (pfds[i].revents && service.running < jobs)
+        ReadClient(service, pfds[i].fd);
+    if (!pfds[0].revents) continue;
+
+    const int fd = accept(service.server, nullptr, nullptr);
+    if (fd < 0) continue;
+    if (!IsOwnClient(fd)) {
+      WriteAll(fd, "error: the service belongs to another user\n");
+      close(fd);
+      continue;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    service.clients[fd];
+  }
+}
+
+int Submit(const std::string& path, std::vector<char*>& args) {
+  const int fd = OpenSocket(path, false);
+  char cwd[PATH_MAX];
+  if (fd < 0 || !getcwd(cwd, sizeof(cwd))) {
+    std::cout << "error: could not connect to " << path << std::endl;
+    return -1;
+  }
+  std::string request = std::string(cwd) + '\0';
+  for (int i = 0; i < args.size(); i++) {
+    const std::string arg = args[i];
+    if (arg == "--submit") {
+      i++;
+      continue;
+    }
+    if (arg.compare(0, 9, "--submit=") == 0) continue;
+    request += arg + '\0';
+  }
+  request += '\0';
+  if (!WriteAll(fd, request)) {
+    std::cout << "error: could not submit the job" << std::endl;
+    return -1;
+  }
+  std::string last;
+  char buffer[4096];
+  ssize_t n;
+  while ((n = read(fd, buffer, sizeof(buffer))) > 0) {
+    fwrite(buffer, 1, n, stdout);
+    last.append(buffer, n);
+    if (last.size() > 256) last.erase(0, last.size() - 256);
+  }
+  fflush(stdout);
+  close(fd);
+  const size_t pos = last.rfind(exit_status_prefix);
+  if (pos == std::string::npos) return -1;
+  return std::atoi(last.c_str() + pos + strlen(exit_status_prefix));
+}
+#endif
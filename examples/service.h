@@ -0,0 +1,36 @@
+#ifndef SERVICE_H_
+#define SERVICE_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "cxxopts.hpp"
+#include "xml_config.h"
+
+//! creates the command line options of nldtool (defined in main.cpp)
+std::unique_ptr<cxxopts::Options> CreateOptions(const char* program);
+
+//! runs nldtool with the parsed options, the jobs of the service share the
+//! cryptos in pool and get generated called once the crypto of their input
+//! file is generated (defined in main.cpp)
+int RunTool(cxxopts::Options& options, std::vector<char*>& args,
+            XmlConfig::CryptoPool* pool,
+            const std::function<void()>& generated = nullptr);
+
+#ifdef __unix__
+/*!
+ * \brief Runs the jobs submitted to the Unix socket at path, at most jobs at
+ * a time.
+ *
+ * Only the user of the service can connect to the socket.
+ */
+int Serve(const std::string& path, int jobs);
+
+//! sends the arguments without --submit to the service at path and prints the
+//! output of the job; returns the exit status of the job
+int Submit(const std::string& path, std::vector<char*>& args);
+#endif
+
+#endif  // SERVICE_H_
@@ -93,29 +93,6 @@ class Sha2::Sigma : public F {
   }
 };
 
-class Sha2::SADD : public F {
- public:
-  static constexpr char kName[] = "SADD";
-  static const int kNumInputs = 5;
-  static const int kNumOutputs = 2;
-  static const int kPrevState = 4;
-  static const int kNextState = 6;
-  static const int kStateSize = 16;
-  static constexpr int Symmetry(int i) { return (i < 3) ? 0 : i; }
-  static constexpr int Bitsize(int i) { return (i == 4 || i == 6) ? 2 : 1; }
-  template <class T>
-  static void f(const T x[kNumInputs], T y[kNumOutputs]) {
-    const int ci = kNumInputs - 1;
-    const int s = 0;
-    const int co = 1;
-    const T cin = {(x[ci].first == 3) ? uint8_t(-1) : x[ci].first,
-                   (x[ci].second == 3) ? uint8_t(-1) : x[ci].second};
-    y[s] = x[0] + x[1] + x[2] - x[3] + cin;
-    y[co] = (y[s] >> 1) & 3;
-    y[s] &= 1;
-  }
-};
-
 constexpr char Sha2::SADD::kName[];
 
 void Sha2::InitWords() {
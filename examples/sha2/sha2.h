@@ -1,7 +1,9 @@
 #ifndef SHA2_H_
 #define SHA2_H_
 
+#include "carry_automaton.h"
 #include "crypto.h"
+#include "functions.h"
 
 /*! \class Sha2
  *  \brief Implementation of the family of SHA-2 crypto functions.
@@ -55,4 +57,46 @@ class Sha2 : public Crypto {
   ConditionWordPtr CA[80];
 };
 
+class Sha2::SADD : public F {
+ public:
+  static constexpr char kName[] = "SADD";
+  static const int kNumInputs = 5;
+  static const int kNumOutputs = 2;
+  static const int kPrevState = 4;
+  static const int kNextState = 6;
+  static const int kStateSize = 16;
+  static constexpr int Symmetry(int i) { return (i < 3) ? 0 : i; }
+  static constexpr int Bitsize(int i) { return (i == 4 || i == 6) ? 2 : 1; }
+  template <class T>
+  static void f(const T x[kNumInputs], T y[kNumOutputs]) {
+    const int ci = kNumInputs - 1;
+    const int s = 0;
+    const int co = 1;
+    const T cin = {(x[ci].first == 3) ? uint8_t(-1) : x[ci].first,
+                   (x[ci].second == 3) ? uint8_t(-1) : x[ci].second};
+    y[s] = x[0] + x[1] + x[2] - x[3] + cin;
+    y[co] = (y[s] >> 1) & 3;
+    y[s] &= 1;
+  }
+};
+
+// x[3] is subtracted and the carries are signed, 3 stands for -1
+template <>
+struct CarrySums<Sha2::SADD> {
+  static const bool kEnabled = true;
+  static const int kNumSums = 1;
+  static constexpr void Add(int i, int x, int sums[]) {
+    if (i < 3)
+      sums[0] += x;
+    else if (i == 3)
+      sums[0] -= x;
+    else
+      sums[0] += (x == 3) ? -1 : x;
+  }
+  static constexpr void Outputs(const int sums[], int y[]) {
+    y[0] = sums[0] & 1;
+    y[1] = (sums[0] >> 1) & 3;
+  }
+};
+
 #endif  // SHA2_H_
@@ -825,35 +825,6 @@ bool Siphash::Callback(std::string function, Characteristic& characteristic,
 }
 
 //----------------------------- ADD Classes ------------------------------------
-class Siphash::ADD2U1U1ROT : public F {
- public:
-  static constexpr char kName[] = "ADD2U1U1ROT";
-  static const int kNumInputs = 5;
-  static const int kNumOutputs = 4;
-  static constexpr int Symmetry(int i) { return (i < 2) ? 0 : i; }
-  static constexpr int Bitsize(int i) { return (i == 4 || i == 8) ? 3 : 1; }
-  static const int kPrevState = 4;
-  static const int kNextState = 8;
-  static const int kStateSize = 64;
-  template <class T>
-  static void f(const T x[kNumInputs], T y[kNumOutputs]) {
-    const int ci = kNumInputs - 1;
-    const int s1 = 0;
-    const int s2 = 1;
-    const int s3 = 2;
-    const int co = 3;
-    y[s1] = x[0] + x[1] + ((x[ci]) & 1);
-    y[co] = (y[s1] & 2) >> 1;
-    y[s1] &= 1;
-    y[s2] = y[s1] + x[2] + ((x[ci] >> 1) & 1);
-    y[co] |= y[s2] & 2;
-    y[s2] &= 1;
-    y[s3] = y[s2] + x[3] + ((x[ci] >> 2) & 1);
-    y[co] |= (y[s3] & 2) << 1;
-    y[s3] &= 1;
-  }
-};
-
 constexpr char Siphash::ADD2U1U1ROT::kName[];
 
 class Siphash::ADD2U1XORU1ROT : public F {
@@ -1,7 +1,9 @@
 #ifndef SIPHASH_H_
 #define SIPHASH_H_
 
+#include "carry_automaton.h"
 #include "crypto.h"
+#include "functions.h"
 
 #define SIPHASH_MAXROUNDS 9
 #define SIPHASH_MAX_MSG_BLOCKS 32
@@ -70,4 +72,57 @@ class Siphash : public Crypto {
                     bool transition_c_to_d, int message_pos);
 };
 
+class Siphash::ADD2U1U1ROT : public F {
+ public:
+  static constexpr char kName[] = "ADD2U1U1ROT";
+  static const int kNumInputs = 5;
+  static const int kNumOutputs = 4;
+  static constexpr int Symmetry(int i) { return (i < 2) ? 0 : i; }
+  static constexpr int Bitsize(int i) { return (i == 4 || i == 8) ? 3 : 1; }
+  static const int kPrevState = 4;
+  static const int kNextState = 8;
+  static const int kStateSize = 64;
+  template <class T>
+  static void f(const T x[kNumInputs], T y[kNumOutputs]) {
+    const int ci = kNumInputs - 1;
+    const int s1 = 0;
+    const int s2 = 1;
+    const int s3 = 2;
+    const int co = 3;
+    y[s1] = x[0] + x[1] + ((x[ci]) & 1);
+    y[co] = (y[s1] & 2) >> 1;
+    y[s1] &= 1;
+    y[s2] = y[s1] + x[2] + ((x[ci] >> 1) & 1);
+    y[co] |= y[s2] & 2;
+    y[s2] &= 1;
+    y[s3] = y[s2] + x[3] + ((x[ci] >> 2) & 1);
+    y[co] |= (y[s3] & 2) << 1;
+    y[s3] &= 1;
+  }
+};
+
+// the second and third sum add the sum bit of the previous one
+template <>
+struct CarrySums<Siphash::ADD2U1U1ROT> {
+  static const bool kEnabled = true;
+  static const int kNumSums = 3;
+  static constexpr void Add(int i, int x, int sums[]) {
+    if (i < 2) {
+      sums[0] += x;
+    } else if (i < 4) {
+      sums[i - 1] += x;
+    } else {
+      for (int k = 0; k < 3; k++) sums[k] += (x >> k) & 1;
+    }
+  }
+  static constexpr void Outputs(const int sums[], int y[]) {
+    const int s2 = (sums[0] & 1) + sums[1];
+    const int s3 = (s2 & 1) + sums[2];
+    y[0] = sums[0] & 1;
+    y[1] = s2 & 1;
+    y[2] = s3 & 1;
+    y[3] = ((sums[0] & 2) >> 1) | (s2 & 2) | ((s3 & 2) << 1);
+  }
+};
+
 #endif  // SIPHASH_H_
@@ -1,9 +1,20 @@
-set(NLDTOOL_FILES
+set(NLDEXAMPLES_FILES
   examples/crypto_factory.cpp
   examples/crypto_factory.h
   examples/crypto_options.cpp
   examples/crypto_options.h
+  examples/tool_options.cpp
+  examples/tool_options.h
+)
+
+set(NLDTOOL_FILES
   examples/main.cpp
+  examples/service.cpp
+  examples/service.h
+)
+
+set(NLDCACHE_FILES
+  examples/nldcache.cpp
 )
 
 # search for available crypto algorithms
@@ -20,7 +31,7 @@ set(NLDTOOL_CRYPTO ${CRYPTO} CACHE STRING
 # add crypto source files
 foreach(i ${NLDTOOL_CRYPTO})
   include(examples/${i}/sources.cmake)
-  set(NLDTOOL_FILES ${NLDTOOL_FILES} ${CRYPTO_FILES})
+  set(NLDEXAMPLES_FILES ${NLDEXAMPLES_FILES} ${CRYPTO_FILES})
 endforeach()
 
 # generate crypto factory file
@@ -97,3 +108,22 @@ endforeach()
 
 # add search test cases for each crypto algorithm (only MD4 for now)
 add_test(md4_search nldtool -i ${CMAKE_SOURCE_DIR}/examples/md4/eurocryptWangLFCY05/start.xml -R 963821092 -E)
+
+# add binary characteristic round trip test case (only MD4 for now), the
+# unchecked characteristic read back must check and print like the text input
+add_test(md4_binary_write nldtool -i ${CMAKE_SOURCE_DIR}/examples/md4/eurocryptWangLFCY05/start.xml --check-char 0 -B md4-start.bin)
+add_test(NAME md4_binary_read COMMAND ${CMAKE_COMMAND}
+  -DNLDTOOL=$<TARGET_FILE:nldtool>
+  -DINPUT_FILE=${CMAKE_SOURCE_DIR}/examples/md4/eurocryptWangLFCY05/start.xml
+  -DBINARY_FILE=md4-start.bin
+  -P ${CMAKE_SOURCE_DIR}/examples/compare_check.cmake)
+set_tests_properties(md4_binary_write PROPERTIES FIXTURES_SETUP md4_binary)
+set_tests_properties(md4_binary_read PROPERTIES FIXTURES_REQUIRED md4_binary)
+
+# add batch check test case (only MD4 for now, globs in the file list)
+file(WRITE ${CMAKE_BINARY_DIR}/md4_check_batch.txt
+  "${CMAKE_SOURCE_DIR}/examples/md4/*/*.xml\n")
+add_test(md4_check_batch nldtool --check-batch ${CMAKE_BINARY_DIR}/md4_check_batch.txt -j 2)
+
+# add cache replay test case (only MD4 for now, does not write caches/)
+add_test(md4_cache_replay nldcache -i ${CMAKE_SOURCE_DIR}/examples/md4/testvectors/md4-test1.xml --replay --coverage)
@@ -0,0 +1,150 @@
+#include "tool_options.h"
+
+void AddToolOptions(cxxopts::Options& options) {
+  options.add_options()                                                 //
+      ("h,help",                                                        //
+       "print help",                                                    //
+       cxxopts::value<bool>(),                                          //
+       "")                                                              //
+      ("v,version",                                                     //
+       "print version",                                                 //
+       cxxopts::value<bool>(),                                          //
+       "")                                                              //
+      ("i,input-file",                                                  //
+       "XML file with input characteristic and configurations",         //
+       cxxopts::value<std::string>(),                                   //
+       "FILE")                                                          //
+      ("l,log-file",                                                    //
+       "filename to write log output (in addition to stdout)",          //
+       cxxopts::value<std::string>(),                                   //
+       "FILE")                                                          //
+      ("c,check-char",                                                  //
+       "check characteristic with level L",                             //
+       cxxopts::value<int>()->default_value("2")->implicit_value("2"),  //
+       "L")                                                             //
+      ("check-batch",                                                   //
+       "check the XML files in FILE, one file or glob per line",        //
+       cxxopts::value<std::string>(),                                   //
+       "FILE")                                                          //
+      ("j,jobs",                                                        //
+       "number of worker processes for check-batch and serve",          //
+       cxxopts::value<int>()->default_value("1"),                       //
+       "N")                                                             //
+      ("serve",                                                         //
+       "run the jobs of submit on the Unix socket FILE",                //
+       cxxopts::value<std::string>(),                                   //
+       "FILE")                                                          //
+      ("submit",                                                        //
+       "run with the other options as a job of the service at FILE",    //
+       cxxopts::value<std::string>(),                                   //
+       "FILE")                                                          //
+      ("s,start-round",                                                 //
+       "start round",                                                   //
+       cxxopts::value<int>()->default_value("0"),                       //
+       "N")                                                             //
+      ("n,num-rounds",                                                  //
+       "number of rounds",                                              //
+       cxxopts::value<int>()->default_value("1"),                       //
+       "N")                                                             //
+      ("b,blocks",                                                      //
+       "number of message blocks",                                      //
+       cxxopts::value<int>()->default_value("1"),                       //
+       "N")                                                             //
+      ("r,rate",                                                        //
+       "rate of a sponge function",                                     //
+       cxxopts::value<int>()->default_value("64"),                      //
+       "N");
+
+  options.add_options("Print")                                       //
+      ("P,print-config",                                             //
+       "XML file with print configuration",                          //
+       cxxopts::value<std::string>()->default_value(                 //
+           "examples/print_config.xml"),                             //
+       "FILE")                                                       //
+      ("I,print-info",                                               //
+       "print info at every restart and in 2 * N second intervals",  //
+       cxxopts::value<int>()->default_value("1"),                    //
+       "N")                                                          //
+      ("C,print-char",                                               //
+       "print characteristic interval in seconds",                   //
+       cxxopts::value<int>()->default_value("-1"),                   //
+       "N")                                                          //
+      ("Z,print-steps",                                              //
+       "print main or all steps",                                    //
+       cxxopts::value<std::string>()->default_value("main"),         //
+       "(main|all)")                                                 //
+      ("p,probability",                                              //
+       "compute and print the differential probability",             //
+       cxxopts::value<bool>(),                                       //
+       "")                                                           //
+      ("m,minfree-threshold",                                        //
+       "threshold to start printing minfree characteristics",        //
+       cxxopts::value<int>()->default_value("200"),                  //
+       "N")                                                          //
+      ("B,binary-output",                                            //
+       "write the checked characteristic in binary format to FILE",  //
+       cxxopts::value<std::string>(),                                //
+       "FILE")                                                       //
+      ("M,metrics-file",                                             //
+       "write the search status as JSON lines to FILE",              //
+       cxxopts::value<std::string>(),                                //
+       "FILE");
+
+  options.add_options("Search")                                 //
+      ("S,search-config",                                       //
+       "XML file with search configuration",                    //
+       cxxopts::value<std::string>(),                           //
+       "FILE")                                                  //
+      ("R,random-seed",                                         //
+       "random seed",                                           //
+       cxxopts::value<int64_t>()->default_value("-1"),          //
+       "SEED")                                                  //
+      ("e,end-time",                                            //
+       "end search after N seconds",                            //
+       cxxopts::value<int>()->default_value("-1"),              //
+       "N")                                                     //
+      ("end-iterations",                                        //
+       "end search after N iterations",                         //
+       cxxopts::value<int64_t>()->default_value("-1"),          //
+       "N")                                                     //
+      ("E,end-found",                                           //
+       "end search once first result has been found",           //
+       cxxopts::value<bool>(),                                  //
+       "")                                                      //
+      ("F,stack-frequency",                                     //
+       "after N guesses, the whole state is put on the stack",  //
+       cxxopts::value<int>()->default_value("100"),             //
+       "N")                                                     //
+      ("d,dump-time",                                           //
+       "generate dump after N hours and quit program",          //
+       cxxopts::value<int>()->default_value("-1"),              //
+       "N")                                                     //
+      ("D,dump-restarts",                                       //
+       "generate dump after N restarts and quit program",       //
+       cxxopts::value<int>()->default_value("-1"),              //
+       "N")                                                     //
+      ("dump-interval",                                         //
+       "write new cache entries to the dumps every N minutes",  //
+       cxxopts::value<int>()->default_value("-1"),              //
+       "N");
+
+  options.add_options("XML")                                  //
+      ("w,word-size",                                         //
+       "word size",                                           //
+       cxxopts::value<int>()->default_value("32"),            //
+       "N")                                                   //
+      ("z,read-steps",                                        //
+       "read main or all steps",                              //
+       cxxopts::value<std::string>()->default_value("main"),  //
+       "(main|all)")                                          //
+      ("f,function",                                          //
+       "cryptographic function to analyze",                   //
+       cxxopts::value<std::string>(),                         //
+       "F")                                                   //
+      ("binary-input",                                        //
+       "read the characteristic from a binary FILE",          //
+       cxxopts::value<std::string>(),                         //
+       "FILE");
+
+  options.parse_positional("input-file");
+}
@@ -0,0 +1,9 @@
+#ifndef TOOL_OPTIONS_H_
+#define TOOL_OPTIONS_H_
+
+#include "cxxopts.hpp"
+
+//! adds the general (not crypto specific) command line options of nldtool
+void AddToolOptions(cxxopts::Options& options);
+
+#endif  // TOOL_OPTIONS_H_
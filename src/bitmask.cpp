@@ -1,26 +1,52 @@
 #include "bitmask.h"
 
+#include <algorithm>
 #include <cassert>
 #include <fstream>
 #include <iostream>
 #include <ostream>
+#include <utility>
 
 #include "utils.h"
 
-Bitmask::Bitmask() : word_size_(0), word_mask_(0), masks_() {}
+Bitmask::Bitmask()
+    : word_size_(0), word_mask_(0), words_(), num_bits_set_(0) {}
 
 Bitmask::Bitmask(int word_size)
-    : word_size_(word_size), word_mask_(nldtool::Mask(word_size_)), masks_() {}
+    : word_size_(word_size),
+      word_mask_(nldtool::Mask(word_size_)),
+      words_(),
+      num_bits_set_(0) {}
 
 Bitmask::~Bitmask() {}
 
 Bitmask::Bitmask(const Bitmask& s)
-    : word_size_(s.word_size_), word_mask_(s.word_mask_), masks_(s.masks_) {}
+    : word_size_(s.word_size_),
+      word_mask_(s.word_mask_),
+      words_(s.words_),
+      num_bits_set_(s.num_bits_set_) {}
+
+Bitmask::Bitmask(Bitmask&& s) noexcept
+    : word_size_(s.word_size_),
+      word_mask_(s.word_mask_),
+      words_(std::move(s.words_)),
+      num_bits_set_(s.num_bits_set_) {
+  s.num_bits_set_ = 0;
+}
 
 Bitmask& Bitmask::operator=(const Bitmask& s) {
   word_size_ = s.word_size_;
   word_mask_ = s.word_mask_;
-  masks_ = s.masks_;
+  words_ = s.words_;
+  num_bits_set_ = s.num_bits_set_;
+  return *this;
+}
+
+Bitmask& Bitmask::operator=(Bitmask&& s) noexcept {
+  word_size_ = s.word_size_;
+  word_mask_ = s.word_mask_;
+  words_.swap(s.words_);
+  std::swap(num_bits_set_, s.num_bits_set_);
   return *this;
 }
 
@@ -28,10 +54,12 @@ Bitmask& Bitmask::operator&=(const Bitmask& rhs) {
   assert(word_size_ == rhs.word_size_);
   assert(CheckMask());
   assert(rhs.CheckMask());
-  int last = !masks_.empty() ? masks_.back().word : 0;
-  int rhs_last = !rhs.masks_.empty() ? rhs.masks_.back().word : 0;
-  int max = std::max(last, rhs_last);
-  for (int i = 0; i <= max; i++) ClearBits(i, ~rhs.GetWordMask(i));
+  const int common = std::min(words_.size(), rhs.words_.size());
+  uint64_t* words = words_.data();
+  const uint64_t* rhs_words = rhs.words_.data();
+  for (int i = 0; i < common; i++) words[i] &= rhs_words[i];
+  std::fill(words_.begin() + common, words_.end(), 0);
+  CountBits();
   return *this;
 }
 
@@ -39,70 +67,50 @@ Bitmask& Bitmask::operator|=(const Bitmask& rhs) {
   assert(word_size_ == rhs.word_size_);
   assert(CheckMask());
   assert(rhs.CheckMask());
-  for (int i = 0; i < rhs.masks_.size(); i++)
-    SetBits(rhs.masks_[i].word, rhs.masks_[i].mask);
+  if (words_.size() < rhs.words_.size()) words_.resize(rhs.words_.size(), 0);
+  uint64_t* words = words_.data();
+  const uint64_t* rhs_words = rhs.words_.data();
+  for (int i = 0; i < rhs.words_.size(); i++) words[i] |= rhs_words[i];
+  CountBits();
   return *this;
 }
 
-bool Bitmask::Empty() const { return masks_.empty(); }
-
 int Bitmask::GetNumWordsSet() const {
   assert(CheckMask());
-  return masks_.size();
+  return words_.size() - std::count(words_.begin(), words_.end(), 0);
 }
 
-int Bitmask::GetNumBitsSet() const {
-  assert(CheckMask());
-  int hw = 0;
-  for (int i = 0; i < masks_.size(); i++)
-    hw += nldtool::HammingWeight(masks_[i].mask);
-  return hw;
+void Bitmask::CountBits() {
+  num_bits_set_ = 0;
+  for (const uint64_t word : words_)
+    num_bits_set_ += nldtool::HammingWeight(word);
 }
 
 bool Bitmask::CheckMask() const {
-  for (int i = 0; i < masks_.size(); ++i)
-    if (masks_[i].mask == 0 || masks_[i].word < 0) return false;
-  return true;
-}
-
-std::vector<Bitmask::WordMask>::iterator Bitmask::ClearBits(
-    std::vector<Bitmask::WordMask>::iterator it, uint64_t mask) {
-  assert(masks_.begin() <= it && it < masks_.end());
-  assert(CheckMask());
-  mask &= word_mask_;
-  it->mask &= ~mask;
-  if (!it->mask) it = masks_.erase(it) - 1;
-  return it;
-}
-
-std::vector<Bitmask::WordMask>::iterator Bitmask::SetBits(
-    std::vector<Bitmask::WordMask>::iterator it, uint64_t mask) {
-  assert(masks_.begin() <= it && it < masks_.end());
-  assert(CheckMask());
-  mask &= word_mask_;
-  it->mask |= mask;
-  return it;
+  int num_bits_set = 0;
+  for (const uint64_t word : words_) {
+    if (word & ~word_mask_) return false;
+    num_bits_set += nldtool::HammingWeight(word);
+  }
+  return num_bits_set == num_bits_set_;
 }
 
 void Bitmask::ClearBits(int word, uint64_t mask) {
   assert(word >= 0);
-  assert(CheckMask());
-  const WordMask wm = {word, 0};
-  auto it = std::lower_bound(masks_.begin(), masks_.end(), wm);
-  if (it != masks_.end() && it->word == word) ClearBits(it, mask);
+  if (word >= words_.size()) return;
+  const uint64_t cleared = words_[word] & mask & word_mask_;
+  words_[word] ^= cleared;
+  num_bits_set_ -= nldtool::HammingWeight(cleared);
 }
 
 void Bitmask::SetBits(int word, uint64_t mask) {
   assert(word >= 0);
-  assert(CheckMask());
   mask &= word_mask_;
   if (!mask) return;
-  const WordMask wm = {word, 0};
-  auto it = std::lower_bound(masks_.begin(), masks_.end(), wm);
-  if (it != masks_.end() && it->word == word)
-    SetBits(it, mask);
-  else
-    masks_.insert(it, {word, mask});
+  if (word >= words_.size()) words_.resize(word + 1, 0);
+  const uint64_t set = mask & ~words_[word];
+  words_[word] |= set;
+  num_bits_set_ += nldtool::HammingWeight(set);
 }
 
 void Bitmask::ClearBit(int bit) {
@@ -132,21 +140,14 @@ void Bitmask::ClearWord(int word) { ClearBits(word, word_mask_); }
 void Bitmask::SetWord(int word) { SetBits(word, word_mask_); }
 
 void Bitmask::SetAll(int num_words) {
-  masks_.reserve(num_words);
-  for (int i = 0; i < num_words; ++i) masks_.push_back({i, word_mask_});
+  if (words_.size() < num_words) words_.resize(num_words, 0);
+  std::fill(words_.begin(), words_.begin() + num_words, word_mask_);
+  CountBits();
 }
 
-void Bitmask::ClearAll() { masks_.clear(); }
-
-uint64_t Bitmask::GetWordMask(int word) const {
-  assert(word >= 0);
-  assert(CheckMask());
-  const WordMask wm = {word, 0};
-  auto it = std::lower_bound(masks_.begin(), masks_.end(), wm);
-  if (it != masks_.end() && it->word == word)
-    return it->mask;
-  else
-    return 0;
+void Bitmask::ClearAll() {
+  std::fill(words_.begin(), words_.end(), 0);
+  num_bits_set_ = 0;
 }
 
 bool Bitmask::GetBit(const Bitpos& pos) const {
@@ -155,48 +156,56 @@ bool Bitmask::GetBit(const Bitpos& pos) const {
   return (GetWordMask(pos.GetWord()) >> pos.GetBit()) & 1;
 }
 
-Bitpos Bitmask::GetRandomBitpos(std::mt19937& rng) const {
-  assert(CheckMask());
-  assert(!Empty());
-  std::uniform_int_distribution<int> dist(0, GetNumBitsSet() - 1);
-  int index = dist(rng);
-  int tmp = 0;
-  for (int i = 0; i < masks_.size(); i++) {
-    tmp += nldtool::HammingWeight(masks_[i].mask);
-    if (index < tmp) {
-      tmp -= nldtool::HammingWeight(masks_[i].mask);
-      for (int j = 0; j < sizeof(uint64_t) * 8; ++j)
-        if ((masks_[i].mask >> j & 1) && tmp++ == index)
-          return Bitpos(masks_[i].word, j);
+Bitpos Bitmask::Select(int index) const {
+  // returns the position of the set bit with the given index, counting the
+  // words and the bits within a word from the lowest one
+  assert(0 <= index && index < num_bits_set_);
+  for (int i = 0; i < words_.size(); i++) {
+    uint64_t word = words_[i];
+    const int count = nldtool::HammingWeight(word);
+    if (index >= count) {
+      index -= count;
+      continue;
     }
+    for (; index > 0; index--) word &= word - 1;
+    return Bitpos(i, nldtool::CountTrailingZeros(word));
   }
   assert(!"error");
   return Bitpos(-1, -1);
 }
 
+Bitpos Bitmask::GetRandomBitpos(std::mt19937& rng) const {
+  assert(CheckMask());
+  assert(!Empty());
+  std::uniform_int_distribution<int> dist(0, GetNumBitsSet() - 1);
+  return Select(dist(rng));
+}
+
 Bitpos Bitmask::First() const {
   assert(!Empty());
   assert(CheckMask());
-  for (int j = 0; j < 64; ++j)
-    if ((masks_[0].mask >> j) & 1) return Bitpos(masks_[0].word, j);
-  assert(!"error");
-  return Bitpos(-1, -1);
+  return Select(0);
 }
 
 std::vector<Bitpos> Bitmask::GetBitposList() const {
-  assert(CheckMask());
   std::vector<Bitpos> list;
-  for (int i = 0; i < masks_.size(); i++)
-    for (int j = 0; j < sizeof(uint64_t) * 8; ++j)
-      if ((masks_[i].mask >> j) & 1) list.push_back(Bitpos(masks_[i].word, j));
+  GetBitposList(list);
   return list;
 }
 
+void Bitmask::GetBitposList(std::vector<Bitpos>& list) const {
+  assert(CheckMask());
+  list.clear();
+  for (int i = 0; i < words_.size(); i++)
+    for (uint64_t word = words_[i]; word; word &= word - 1)
+      list.push_back(Bitpos(i, nldtool::CountTrailingZeros(word)));
+}
+
 void Bitmask::WriteMask(std::ostream& fs) const {
-  for (int i = 0; i < masks_.size(); i++) {
-    fs << masks_[i].word << "\t";
-    for (int j = word_size_ - 1; j >= 0; j--)
-      fs << ((masks_[i].mask >> j) & 1ull);
+  for (int i = 0; i < words_.size(); i++) {
+    if (!words_[i]) continue;
+    fs << i << "\t";
+    for (int j = word_size_ - 1; j >= 0; j--) fs << ((words_[i] >> j) & 1ull);
     fs << std::endl;
   }
 }
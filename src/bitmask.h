@@ -12,36 +12,30 @@
 /*!
  * \brief A mask for words, enabling the bitwise selection of parts of a word
  * or multiple words.
+ *
+ * The mask is stored densely with one uint64_t per word, indexed by the word
+ * number, and the number of set bits is kept up to date. Words beyond the
+ * stored ones are empty. Clearing bits keeps the storage, so a mask that is
+ * regenerated over and over again does not reallocate.
  */
 class Bitmask {
-  struct WordMask {
-    int word;
-    uint64_t mask;
-    bool operator<(const WordMask& a) const {
-      return (word < a.word) || (word == a.word && mask < a.mask);
-    }
-  };
-
  public:
   Bitmask();
   Bitmask(int word_size);
   Bitmask(const Bitmask& s);
+  Bitmask(Bitmask&& s) noexcept;
   virtual ~Bitmask();
 
   Bitmask& operator=(const Bitmask& s);
+  Bitmask& operator=(Bitmask&& s) noexcept;
   Bitmask& operator&=(const Bitmask& rhs);
   Bitmask& operator|=(const Bitmask& rhs);
 
-  bool Empty() const;
-  int GetNumBitsSet() const;
+  bool Empty() const { return num_bits_set_ == 0; }
+  int GetNumBitsSet() const { return num_bits_set_; }
   int GetNumWordsSet() const;
-
-  std::vector<WordMask>::iterator begin() { return masks_.begin(); }
-  std::vector<WordMask>::iterator end() { return masks_.end(); }
-  std::vector<WordMask>::iterator ClearBits(std::vector<WordMask>::iterator it,
-                                            uint64_t mask);
-  std::vector<WordMask>::iterator SetBits(std::vector<WordMask>::iterator it,
-                                          uint64_t mask);
+  // upper bound for the words with set bits
+  int GetNumWords() const { return words_.size(); }
 
   void ClearBits(int word, uint64_t mask);
   void SetBits(int word, uint64_t mask);
@@ -56,21 +50,27 @@ class Bitmask {
   void ClearAll();
   void SetAll(int num_words);
 
-  uint64_t GetWordMask(int word) const;
+  uint64_t GetWordMask(int word) const {
+    return word < words_.size() ? words_[word] : 0;
+  }
   bool GetBit(const Bitpos& pos) const;
   Bitpos GetRandomBitpos(std::mt19937& rng) const;
   Bitpos First() const;
   std::vector<Bitpos> GetBitposList() const;
+  void GetBitposList(std::vector<Bitpos>& list) const;
 
   void WriteMask(std::ostream& fs) const;
   void PrintMask(const std::string& file_name = "") const;
 
  private:
   bool CheckMask() const;
+  void CountBits();
+  Bitpos Select(int index) const;
 
   int word_size_;
   uint64_t word_mask_;
-  std::vector<WordMask> masks_;
+  std::vector<uint64_t> words_;
+  int num_bits_set_;
 };
 
 #endif  // BITMASK_H_
@@ -2,17 +2,21 @@
 #define BITSLICE_H_
 
 #include <cassert>
+#include <chrono>
 #include <cstdint>
 #include <iostream>
 
 #include "cache.h"
+#include "carry_automaton.h"
 #include "probability.h"
 #include "probability_matrix.h"
 #include "probability_output.h"
 #include "propagate.h"
 #include "propagate_twobit.h"
 #include "propagate_twobit_output.h"
+#include "sbox_table.h"
 #include "utils.h"
+#include "xor_sumset.h"
 
 /*!
  * \brief The bitslice for a given function, with a caching mechanism for
@@ -23,18 +27,32 @@
  * of the search. For larger functions, the cache is build dynamically during
  * the search. The input conditions of a bitslice function are expanded and then
  * the Loop function calculates all outputs, using the appropriate \see Action
- * to combine the results.
+ * to combine the results. Modular additions, larger XORs and S-boxes are
+ * propagated by their \see CarryAutomaton, \see XorSumset and \see SboxTable
+ * instead, which is faster than a lookup in the cache.
  */
 template <class F>
 class Bitslice {
  public:
   static void InitCaches() {
+    cache_.SetName(Propagate<F>::GetName() + "_" + F::kName);
+    probability_cache_.SetName(Probability<F>::GetName() + "_" + F::kName);
+    probability_matrix_cache_.SetName(ProbabilityMatrix<F>::GetName() + "_" +
+                                      F::kName);
+    twobit_cache_.SetName(PropagateTwobit<F>::GetName() + "_" + F::kName);
     InitStaticCachePropagate();
     InitStaticCacheProbability();
     InitStaticCachePropagateTwobit();
   }
 
+  // true if Compute does not need the cache for the function
+  static constexpr bool HasDirectPropagation() {
+    return CarryAutomaton<F>::kEnabled || XorSumset<F>::kEnabled ||
+           SboxTable<F>::kEnabled;
+  }
+
   static void InitStaticCachePropagate() {
+    if (HasDirectPropagation()) return;
     std::string filepath =
         "CacheDump_" + Propagate<F>::GetName() + "_" + F::kName + ".db";
     cache_.SetDumpFilepathAndLoadDump(filepath.c_str());
@@ -107,68 +125,88 @@ class Bitslice {
   }
 
   static BitsliceData<F> Compute(BitsliceData<F> input) {
-    typename CacheBase<BitsliceData<F>, BitsliceData<F>>::Match result;
-    BitsliceData<F> output;
+    if (CarryAutomaton<F>::kEnabled) return CarryAutomaton<F>::Propagate(input);
+    if (XorSumset<F>::kEnabled) return XorSumset<F>::Propagate(input);
+    if (SboxTable<F>::kEnabled) return SboxTable<F>::Propagate(input);
     uint8_t perm[16] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
-    input.SortInput(perm);
-    result = cache_.Find(input);
-    if (result.matched) {
-      output = result.second;
-    } else {
-      output = Loop<Propagate<F>>(input);
-      cache_.Insert(input, output);
-    }
-    output.ResortOutput(perm, F::kNumInputs + F::kNumOutputs);
+    const bool permuted = input.SortInput(perm);
+    BitsliceData<F> output = Lookup<Propagate<F>>(cache_, input);
+#ifdef CACHE_STATISTICS
+    // all conditions are empty for a contradiction; a negative cache for
+    // them is not worth a probe: only 0.1-0.2% of the step updates in md4,
+    // md5, sha2, skein and siphash searches contradict, a failed guess
+    // spends its time in the successful updates before
+    if (!output.GetCondition(0)) cache_.GetStatistics().contradictions++;
+#endif
+    if (permuted) output.ResortOutput(perm, F::kNumInputs + F::kNumOutputs);
     return output;
   }
 
+  // prefetches the cache entry that Compute will use for the input
+  static void Prefetch(BitsliceData<F> input) {
+    if (HasDirectPropagation()) return;
+    uint8_t perm[16] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+    input.SortInput(perm);
+    cache_.Prefetch(input);
+  }
+
   static ProbabilityOutput ComputeProbability(BitsliceData<F> input) {
-    typename CacheBase<BitsliceData<F>, ProbabilityOutput>::Match result;
-    ProbabilityOutput output;
     uint8_t perm[16] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
     input.SortInput(perm);
-    result = probability_cache_.Find(input);
-    if (result.matched) {
-      output = result.second;
-    } else {
-      output = Loop<Probability<F>>(input);
-      probability_cache_.Insert(input, output);
-    }
-    return output;
+    return Lookup<Probability<F>>(probability_cache_, input);
   }
 
   static ProbabilityOutputMatrix ComputeProbabilityMatrix(
       BitsliceData<F> input) {
-    typename CacheBase<BitsliceData<F>, ProbabilityOutputMatrix>::Match result;
-    ProbabilityOutputMatrix output;
     uint8_t perm[16] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
     input.SortInput(perm);
-    result = probability_matrix_cache_.Find(input);
-    if (result.matched) {
-      output = result.second;
-    } else {
-      output = Loop<ProbabilityMatrix<F>>(input);
-      probability_matrix_cache_.Insert(input, output);
-    }
-    return output;
+    return Lookup<ProbabilityMatrix<F>>(probability_matrix_cache_, input)
+        .Expand();
   }
 
-  static PropagateTwobitOutput ComputeTwobit(BitsliceData<F> input) {
-    typename CacheBase<BitsliceData<F>, PropagateTwobitOutput>::Match result;
-    PropagateTwobitOutput output;
+  // the result is valid until the next call; it reuses the storage of the
+  // previous results, so a cache hit does not allocate
+  static const PropagateTwobitOutput& ComputeTwobit(BitsliceData<F> input) {
     uint8_t perm[16] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
-    input.SortInput(perm);
-    result = twobit_cache_.Find(input);
-    if (result.matched) {
-      output = result.second;
-    } else {
-      output = Loop<PropagateTwobit<F>>(input);
-      twobit_cache_.Insert(input, output);
-    }
-    output.ResortOutput(perm, F::kNumInputs + F::kNumOutputs);
+    const bool permuted = input.SortInput(perm);
+    Lookup<PropagateTwobit<F>>(twobit_cache_, input, twobit_output_);
+    if (permuted)
+      twobit_output_.ResortOutput(perm, F::kNumInputs + F::kNumOutputs);
+    return twobit_output_;
+  }
+
+  // returns the cached result for the (sorted) input or computes and inserts
+  // it on a miss
+  template <class A, class C>
+  static typename A::Output Lookup(C& cache, const typename A::Input& input) {
+    typename A::Output output;
+    Lookup<A>(cache, input, output);
     return output;
   }
 
+  // like Lookup, but assigns the result to output
+  template <class A, class C>
+  static void Lookup(C& cache, const typename A::Input& input,
+                     typename A::Output& output) {
+    if (cache.Find(input, output)) {
+#ifdef CACHE_STATISTICS
+      cache.GetStatistics().hits++;
+#endif
+      return;
+    }
+#ifdef CACHE_STATISTICS
+    const auto start = std::chrono::steady_clock::now();
+#endif
+    output = Loop<A>(input);
+    cache.Insert(input, output);
+#ifdef CACHE_STATISTICS
+    cache.GetStatistics().misses++;
+    cache.GetStatistics().miss_seconds +=
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+            .count();
+#endif
+  }
+
   template <class A>
   static typename A::Output Loop(typename A::Input input) {
     A action;
@@ -236,10 +274,13 @@ class Bitslice {
   static typename Cache<BitsliceData<F>, BitsliceData<F>>::result cache_;
   static typename Cache<BitsliceData<F>, ProbabilityOutput>::result
       probability_cache_;
-  static typename Cache<BitsliceData<F>, ProbabilityOutputMatrix>::result
+  static typename Cache<BitsliceData<F>,
+                        ProbabilityOutputSparseMatrix<F::kStateSize>>::result
       probability_matrix_cache_;
   static typename Cache<BitsliceData<F>, PropagateTwobitOutput>::result
       twobit_cache_;
+  // the result of ComputeTwobit
+  static PropagateTwobitOutput twobit_output_;
 };
 
 template <class F>
@@ -248,10 +289,13 @@ template <class F>
 typename Cache<BitsliceData<F>, ProbabilityOutput>::result
     Bitslice<F>::probability_cache_;
 template <class F>
-typename Cache<BitsliceData<F>, ProbabilityOutputMatrix>::result
+typename Cache<BitsliceData<F>,
+               ProbabilityOutputSparseMatrix<F::kStateSize>>::result
     Bitslice<F>::probability_matrix_cache_;
 template <class F>
 typename Cache<BitsliceData<F>, PropagateTwobitOutput>::result
     Bitslice<F>::twobit_cache_;
+template <class F>
+PropagateTwobitOutput Bitslice<F>::twobit_output_;
 
 #endif  // BITSLICE_H_
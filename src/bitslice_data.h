@@ -8,6 +8,7 @@
 #include <iostream>
 #include <ostream>
 #include <string>
+#include <utility>
 
 #include "bitslice_pair.h"
 #include "index.h"
@@ -121,21 +122,41 @@ class BitsliceData {
     SetCondition(b, aa);
   }
 
-  void SortInput(uint8_t perm[]) {
+  // true if two conditions are in the same symmetry group of the function
+  static constexpr bool HasSymmetry() {
+    for (int i = 0; i < F::kNumInputs + F::kNumOutputs; i++)
+      for (int j = i + 1; j < F::kNumInputs + F::kNumOutputs; j++)
+        if (F::Symmetry(i) == F::Symmetry(j)) return true;
+    return false;
+  }
+
+  // sorts the conditions of each symmetry group in descending order and
+  // records the original positions in perm, returns false if nothing moved
+  bool SortInput(uint8_t perm[]) {
+    if (!HasSymmetry()) return false;
+    uint64_t conditions[F::kNumInputs + F::kNumOutputs];
+    for (int i = 0; i < F::kNumInputs + F::kNumOutputs; i++)
+      conditions[i] = GetCondition(i);
+    bool permuted = false;
     for (int i = 0; i < F::kNumInputs + F::kNumOutputs; i++)
       for (int j = i + 1; j < F::kNumInputs + F::kNumOutputs; j++)
         if (F::Symmetry(i) == F::Symmetry(j) &&
-            GetCondition(i) < GetCondition(j)) {
-          SwapCondition(i, j);
+            conditions[i] < conditions[j]) {
+          std::swap(conditions[i], conditions[j]);
           std::swap(perm[i], perm[j]);
+          permuted = true;
         }
+    if (!permuted) return false;
+    for (int i = 0; i < F::kNumInputs + F::kNumOutputs; i++)
+      SetCondition(i, conditions[i]);
+    return true;
   }
 
   void ResortOutput(uint8_t perm[], int len) {
-    BitsliceData<F> tmp = *this;
-    for (int i = 0; i < len; i++) {
-      SetCondition(perm[i], tmp.GetCondition(i));
-    }
+    assert(len <= F::kNumInputs + F::kNumOutputs);
+    uint64_t conditions[F::kNumInputs + F::kNumOutputs];
+    for (int i = 0; i < len; i++) conditions[i] = GetCondition(i);
+    for (int i = 0; i < len; i++) SetCondition(perm[i], conditions[i]);
   }
 
   bool SetupPairs(Pair pairs[64][F::kNumInputs],
@@ -94,6 +94,21 @@ class BitsliceStep : public Step {
     }
   }
 
+  virtual void CompileConditionAccess(Crypto& crypto) {
+    condition_access_.clear();
+    condition_access_.reserve(word_size_ * GetNumParams());
+    for (int bit = 0; bit < word_size_; bit++)
+      for (int i = 0; i < GetNumParams(); i++)
+        condition_access_.push_back(
+            crypto.CompileConditionAccess(*GetConditionProxy(i, bit)));
+  }
+
+  // the compiled accesses of all parameters at the given bit
+  const ConditionAccess* GetConditionAccess(int pos) const {
+    assert(condition_access_.size() == word_size_ * GetNumParams());
+    return &condition_access_[pos * GetNumParams()];
+  }
+
   virtual std::string GetName() const { return std::string(F::kName); }
 
   virtual BitsliceStepData* CreateStepData() const {
@@ -109,13 +124,12 @@ class BitsliceStep : public Step {
                       bool backtrack = false) const {
     bool result = true;
     BitsliceData<F> input, output;
+    const ConditionAccess* access = GetConditionAccess(pos);
     for (int i = 0; i < F::kNumInputs + F::kNumOutputs; i++)
-      input.SetCondition(
-          i, GetConditionProxy(i, pos)->GetCondition(characteristic));
+      input.SetCondition(i, characteristic.GetCondition(access[i]));
     output = Bitslice<F>::Compute(input);
     for (int i = 0; i < F::kNumInputs + F::kNumOutputs; i++)
-      result &= GetConditionProxy(i, pos)->SetCondition(characteristic,
-                                                        output.GetCondition(i));
+      result &= characteristic.SetCondition(access[i], output.GetCondition(i));
 #ifdef DEBUG_STEP
     std::cout << F::kName << Bitpos(step_index_, pos) << ": ";
     std::cout << input << " -> " << output;
@@ -124,16 +138,33 @@ class BitsliceStep : public Step {
     return result;
   }
 
-  virtual std::vector<TwobitCondition> UpdateTwobitCondition(
-      Characteristic& characteristic, Bitpos pos) const {
+  virtual void Prefetch(const Characteristic& characteristic,
+                        uint64_t bits) const {
+    // the static caches are small enough to stay in the CPU caches
+    if (BitsliceData<F>::NUMBITS <= MAX_STATIC_CACHE_SIZE ||
+        Bitslice<F>::HasDirectPropagation())
+      return;
+    for (int pos = 0; bits; pos++, bits >>= 1) {
+      if (!(bits & 1)) continue;
+      BitsliceData<F> input;
+      const ConditionAccess* access = GetConditionAccess(pos);
+      for (int i = 0; i < F::kNumInputs + F::kNumOutputs; i++)
+        input.SetCondition(i, characteristic.GetCondition(access[i]));
+      Bitslice<F>::Prefetch(input);
+    }
+  }
+
+  virtual void UpdateTwobitCondition(
+      Characteristic& characteristic, Bitpos pos,
+      std::vector<TwobitCondition>& twobit) const {
     BitsliceData<F> input;
-    PropagateTwobitOutput output;
+    const ConditionAccess* access = GetConditionAccess(pos.GetBit());
     for (int i = 0; i < F::kNumInputs + F::kNumOutputs; i++)
-      input.SetCondition(
-          i, GetConditionProxy(i, pos.GetBit())->GetCondition(characteristic));
-    output = Bitslice<F>::ComputeTwobit(input);
-    std::vector<TwobitCondition> twobit;
-    twobit.reserve(output.twobit_list_.size());
+      input.SetCondition(i, characteristic.GetCondition(access[i]));
+    const PropagateTwobitOutput& output = Bitslice<F>::ComputeTwobit(input);
+#ifdef DEBUG_STEP
+    const int first = twobit.size();
+#endif
     for (int i = 0; i < output.twobit_list_.size(); i++) {
       ConditionProxyPtr cpa =
           GetConditionProxy(output.twobit_list_[i].a, pos.GetBit());
@@ -160,10 +191,9 @@ class BitsliceStep : public Step {
 #ifdef DEBUG_STEP
     std::cout << F::kName << bitslice_pos << ": " << input << " -> " << output
               << " -> ";
-    for (int i = 0; i < twobit.size(); i++) std::cout << twobit[i] << " ";
+    for (int i = first; i < twobit.size(); i++) std::cout << twobit[i] << " ";
     std::cout << std::endl;
 #endif
-    return twobit;
   }
 
   const std::multimap<Bitpos, int>& GetBitslicesToUpdate() {
@@ -176,9 +206,9 @@ class BitsliceStep : public Step {
       case Crypto::BITSLICE:  // probability for every single bitslice
         for (int pos = 0; pos < word_size_; ++pos) {
           BitsliceData<F> input;
+          const ConditionAccess* access = GetConditionAccess(pos);
           for (int i = 0; i < F::kNumInputs + F::kNumOutputs; i++)
-            input.SetCondition(
-                i, GetConditionProxy(i, pos)->GetCondition(characteristic));
+            input.SetCondition(i, characteristic.GetCondition(access[i]));
           probability += Bitslice<F>::ComputeProbability(input).probability_;
         }
         break;
@@ -188,9 +218,9 @@ class BitsliceStep : public Step {
         matrices.reserve(word_size_);
         for (int pos = 0; pos < word_size_; ++pos) {
           BitsliceData<F> input;
+          const ConditionAccess* access = GetConditionAccess(pos);
           for (int i = 0; i < F::kNumInputs + F::kNumOutputs; ++i)
-            input.SetCondition(
-                i, GetConditionProxy(i, pos)->GetCondition(characteristic));
+            input.SetCondition(i, characteristic.GetCondition(access[i]));
           matrices.push_back(Bitslice<F>::ComputeProbabilityMatrix(input));
         }
         // merge states
@@ -252,6 +282,7 @@ class BitsliceStep : public Step {
  protected:
   std::multimap<Bitpos, int> bitslices_to_update_;
   std::vector<Mapping> mapping_;
+  std::vector<ConditionAccess> condition_access_;
 };
 
 #endif  // BITSLICE_STEP_H_
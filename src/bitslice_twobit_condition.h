@@ -16,7 +16,7 @@ class BitsliceTwobitCondition {
   uint8_t c;
 
   friend std::ostream& operator<<(std::ostream& os,
-                                  BitsliceTwobitCondition& t) {
+                                  const BitsliceTwobitCondition& t) {
     assert(t.c < 16);
     os << (int)t.a;
     if (t.c == 0)
@@ -23,6 +23,11 @@ class CacheBase : public ManagableCache {
   virtual ~CacheBase() {}
   virtual void Insert(const Key key, const Data value) = 0;
   virtual Match Find(const Key key) /*const*/ = 0;
+
+  // like Find, but assigns a cached value to data, which keeps its storage
+  virtual bool Find(const Key key, Data& data) = 0;
+  // hint that the key will be looked up soon
+  virtual void Prefetch(const Key key) const {}
   virtual void Clear() = 0;
   virtual int64_t GetSize() = 0;
   virtual void SetSize(int64_t size) = 0;
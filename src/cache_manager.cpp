@@ -1,3 +1,124 @@
 #include "cache_manager.h"
 
+#include <cstdio>
+#include <string>
+#include <utility>
+
 CacheManager* CacheManager::instance = nullptr;
+
+namespace {
+
+bool WriteSnapshot(const CacheSnapshot& snapshot) {
+  const std::string path =
+      snapshot.append ? snapshot.filepath : snapshot.filepath + ".tmp";
+  FILE* file = fopen(path.c_str(), snapshot.append ? "a" : "w");
+  if (file == nullptr) return false;
+  const bool written =
+      fwrite(snapshot.bytes.data(), snapshot.bytes.size(), 1, file) == 1;
+  if (fclose(file) != 0 || !written) return false;
+  return snapshot.append ||
+         std::rename(path.c_str(), snapshot.filepath.c_str()) == 0;
+}
+
+}  // namespace
+
+CacheManager::~CacheManager() {
+  if (!writer_.joinable()) return;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  queue_changed_.notify_all();
+  writer_.join();
+}
+
+void CacheManager::SnapshotAllCachesInternal() {
+  bool full;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // the new entries stay in the caches for the next snapshot
+    if (writing_ || !snapshots_.empty()) return;
+    full = failed_;
+    failed_ = false;
+  }
+  // the writer only gets copies, so the caches are serialized without a lock
+  std::deque<CacheSnapshot> snapshots;
+  for (ManagableCache* cache : caches) {
+    CacheSnapshot snapshot;
+    if (cache->TakeSnapshot(snapshot, full))
+      snapshots.push_back(std::move(snapshot));
+  }
+  if (snapshots.empty()) return;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    snapshots_.swap(snapshots);
+    if (!writer_.joinable())
+      writer_ = std::thread(&CacheManager::WriterLoop, this);
+  }
+  queue_changed_.notify_all();
+}
+
+void CacheManager::FlushSnapshotsInternal() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  queue_changed_.wait(lock,
+                      [this] { return snapshots_.empty() && !writing_; });
+}
+
+void CacheManager::WriterLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    queue_changed_.wait(lock, [this] { return stop_ || !snapshots_.empty(); });
+    if (snapshots_.empty()) break;
+    CacheSnapshot snapshot = std::move(snapshots_.front());
+    snapshots_.pop_front();
+    writing_ = true;
+    lock.unlock();
+    const bool written = WriteSnapshot(snapshot);
+    if (!written)
+      std::cerr << "writing cache dump file " << snapshot.filepath
+                << " failed" << std::endl;
+    lock.lock();
+    writing_ = false;
+    failed_ |= !written;
+    queue_changed_.notify_all();
+  }
+}
+
+void CacheManager::PrintStatisticsInternal(std::ostream& os) {
+  for (ManagableCache* cache : caches) {
+    const CacheStatistics& s = cache->GetStatistics();
+    const uint64_t lookups = s.hits + s.misses;
+    if (lookups == 0) continue;
+    os << "Cache: " << cache->GetName();
+    os << " size: " << cache->GetSize();
+    os << " hits: " << s.hits;
+    os << " misses: " << s.misses;
+    os << " hitrate: " << double(s.hits) / lookups;
+    os << " evictions: " << s.evictions;
+    os << " contradictions: " << s.contradictions;
+    os << " miss_time: " << s.miss_seconds;
+    os << " miss_us: " << (s.misses ? 1e6 * s.miss_seconds / s.misses : 0);
+    os << std::endl;
+  }
+}
+
+void CacheManager::WriteStatisticsJsonInternal(std::ostream& os) {
+  bool first = true;
+  os << "[";
+  for (ManagableCache* cache : caches) {
+    const CacheStatistics& s = cache->GetStatistics();
+    const uint64_t lookups = s.hits + s.misses;
+    if (lookups == 0) continue;
+    os << (first ? "" : ",");
+    os << "{\"name\":\"" << cache->GetName() << "\"";
+    os << ",\"size\":" << cache->GetSize();
+    os << ",\"hits\":" << s.hits;
+    os << ",\"misses\":" << s.misses;
+    os << ",\"hitrate\":" << double(s.hits) / lookups;
+    os << ",\"evictions\":" << s.evictions;
+    os << ",\"contradictions\":" << s.contradictions;
+    os << ",\"miss_time\":" << s.miss_seconds << "}";
+    first = false;
+  }
+  os << "]";
+}
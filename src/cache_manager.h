@@ -1,6 +1,11 @@
 #ifndef CACHE_MANAGER_H_
 #define CACHE_MANAGER_H_
 
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 #include "managable_cache.h"
@@ -8,13 +13,33 @@
 /*!
  * \brief A singleton class that manages all caches and can dump them all if
  * requested.
+ *
+ * Snapshots of the caches are written by a background thread while the search
+ * continues. The first snapshot of a cache replaces its dump file, the later
+ * ones only append the new entries. A replaced file is written to a temporary
+ * file first and then renamed, so it is never left half written.
  */
 class CacheManager {
   std::vector<ManagableCache*> caches;
   static CacheManager* instance;
   bool already_dumped;
 
-  CacheManager() { already_dumped = false; }
+  std::deque<CacheSnapshot> snapshots_;
+  bool writing_;
+  // a write failed, so the next snapshot replaces the dump files
+  bool failed_;
+  bool stop_;
+  std::mutex mutex_;
+  std::condition_variable queue_changed_;
+  std::thread writer_;
+
+  CacheManager() {
+    already_dumped = false;
+    writing_ = false;
+    failed_ = false;
+    stop_ = false;
+  }
+  ~CacheManager();
 
   static CacheManager* getInstance() {
     if (instance == nullptr) instance = new CacheManager();
@@ -26,10 +51,33 @@ class CacheManager {
     getInstance()->caches.push_back(cache);
   }
 
+  static const std::vector<ManagableCache*>& GetCaches() {
+    return getInstance()->caches;
+  }
+
   static void DumpAllCaches(bool dump_again = false) {
     getInstance()->DumpAllCachesInternal(dump_again);
   }
 
+  // hands the new entries of all caches to the background thread, unless it
+  // is still writing the last snapshot
+  static void SnapshotAllCaches() {
+    getInstance()->SnapshotAllCachesInternal();
+  }
+
+  // waits until all snapshots have been written
+  static void FlushSnapshots() { getInstance()->FlushSnapshotsInternal(); }
+
+  // prints the statistics of all used caches (see CACHE_STATISTICS)
+  static void PrintStatistics(std::ostream& os) {
+    getInstance()->PrintStatisticsInternal(os);
+  }
+
+  // writes the statistics of all used caches as JSON array
+  static void WriteStatisticsJson(std::ostream& os) {
+    getInstance()->WriteStatisticsJsonInternal(os);
+  }
+
   static void Destroy() {
     if (instance != nullptr) {
       getInstance()->caches.clear();
@@ -39,9 +87,16 @@ class CacheManager {
   }
 
  private:
+  void PrintStatisticsInternal(std::ostream& os);
+  void WriteStatisticsJsonInternal(std::ostream& os);
+  void SnapshotAllCachesInternal();
+  void FlushSnapshotsInternal();
+  void WriterLoop();
+
   void DumpAllCachesInternal(bool dump_again) {
     if (already_dumped && !dump_again) return;
     already_dumped = true;
+    FlushSnapshotsInternal();
     CacheManager* instance = getInstance();
     for (int i = 0; i < instance->caches.size(); ++i)
       instance->caches[i]->SaveDump();
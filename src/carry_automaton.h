@@ -0,0 +1,469 @@
+#ifndef CARRY_AUTOMATON_H_
+#define CARRY_AUTOMATON_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "bitslice_data.h"
+#include "functions.h"
+#include "utils.h"
+
+/*!
+ * \brief Description of a bitslice function that adds its inputs, for the
+ * \see CarryAutomaton.
+ *
+ * The default does not know the function, so \see Bitslice uses the cache and
+ * the \see Loop for it. A description gives the number of partial sums that
+ * the inputs are added to, Add for the contribution of an input value (with
+ * its weight and sign, and how the carry input is split over the sums) and
+ * Outputs for the output values of the final sums (including sums that are
+ * chained to the sum bit of another one, and how the carry output is
+ * assembled). An input with value 0 must not change the sums.
+ */
+template <class F>
+struct CarrySums {
+  static const bool kEnabled = false;
+};
+
+// the modular additions have their own automaton below
+template <int N>
+struct CarrySums<ADD<N>> {
+  static const bool kEnabled = true;
+};
+
+// the 2-bit inputs are added to the sums of the low and the high bits, the
+// carry input to the low bits
+template <int N>
+struct CarrySums<ADDB<N>> {
+  static const bool kEnabled = true;
+  static const int kNumSums = 2;
+  static constexpr void Add(int i, int x, int sums[]) {
+    if (i == N) {
+      sums[0] += x;
+    } else {
+      sums[0] += x & 1;
+      sums[1] += x >> 1;
+    }
+  }
+  static constexpr void Outputs(const int sums[], int y[]) {
+    const int sum = sums[0] + 2 * sums[1];
+    y[0] = sum & 3;
+    y[1] = sums[0] >> 1;
+    y[2] = sum >> 2;
+  }
+};
+
+/*!
+ * \brief Propagation of a bitslice function with a carry automaton instead of
+ * enumerating all pairs.
+ *
+ * The default is for functions without a \see CarrySums description, which
+ * are propagated with the cache and the \see Loop.
+ */
+template <class F, bool = CarrySums<F>::kEnabled>
+class CarryAutomaton {
+ public:
+  static const bool kEnabled = false;
+
+  static BitsliceData<F> Propagate(const BitsliceData<F>& input) {
+    return input;
+  }
+};
+
+/*!
+ * \brief The states of the \see CarryAutomaton of a function and their
+ * transitions, computed at compile time from its \see CarrySums.
+ *
+ * The partial sums are numbered in mixed radix, so adding an input value moves
+ * a state by a fixed offset. The carry input (the last one) is added first, it
+ * has the most pairs, but starts from a single state.
+ */
+template <class F>
+struct CarryStates {
+  typedef CarrySums<F> Sums;
+  static const int kMaxValues = 8;
+
+  // the smallest or largest value of partial sum k of all inputs
+  static constexpr int Bound(int k, bool largest) {
+    int bound = 0;
+    for (int i = 0; i < F::kNumInputs; i++) {
+      int extreme = 0;
+      for (int x = 0; x < (1 << F::Bitsize(i)); x++) {
+        int sums[Sums::kNumSums] = {};
+        Sums::Add(i, x, sums);
+        if (largest ? sums[k] > extreme : sums[k] < extreme) extreme = sums[k];
+      }
+      bound += extreme;
+    }
+    return bound;
+  }
+
+  // the factor of partial sum k in the number of a state
+  static constexpr int Radix(int k) {
+    int radix = 1;
+    for (int j = 0; j < k; j++) radix *= Bound(j, true) - Bound(j, false) + 1;
+    return radix;
+  }
+
+  static constexpr int Encode(const int sums[]) {
+    int state = 0;
+    for (int k = 0; k < Sums::kNumSums; k++)
+      state += (sums[k] - Bound(k, false)) * Radix(k);
+    return state;
+  }
+
+  static constexpr int Start() {
+    int sums[Sums::kNumSums] = {};
+    return Encode(sums);
+  }
+
+  // the input added in step j
+  static constexpr int Input(int j) {
+    return (j == 0) ? F::kNumInputs - 1 : j - 1;
+  }
+
+  static const int kNumStates = Radix(Sums::kNumSums);
+  static_assert(kNumStates <= 64, "the states have to fit into 64 bits");
+  static const int kStart = Start();
+
+  // offset of the state when an input value is added
+  int offsets[F::kNumInputs][kMaxValues] = {};
+  // range of the partial sums s before step j
+  int begin[F::kNumInputs + 1] = {};
+  int end[F::kNumInputs + 1] = {};
+  // output values of the final states
+  int outputs[kNumStates][F::kNumOutputs] = {};
+  // final states with an output value, as bitmask
+  uint64_t output_states[F::kNumOutputs][kMaxValues] = {};
+
+  constexpr CarryStates() {
+    for (int i = 0; i < F::kNumInputs; i++) {
+      for (int x = 0; x < (1 << F::Bitsize(i)); x++) {
+        int sums[Sums::kNumSums] = {};
+        Sums::Add(i, x, sums);
+        offsets[i][x] = Encode(sums) - kStart;
+      }
+    }
+    begin[0] = kStart;
+    end[0] = kStart + 1;
+    for (int j = 0; j < F::kNumInputs; j++) {
+      int lowest = 0, highest = 0;
+      for (int x = 0; x < (1 << F::Bitsize(Input(j))); x++) {
+        const int offset = offsets[Input(j)][x];
+        if (offset < lowest) lowest = offset;
+        if (offset > highest) highest = offset;
+      }
+      begin[j + 1] = begin[j] + lowest;
+      end[j + 1] = end[j] + highest;
+    }
+    for (int s = 0; s < kNumStates; s++) {
+      int sums[Sums::kNumSums] = {};
+      for (int k = 0; k < Sums::kNumSums; k++)
+        sums[k] = s / Radix(k) % (Bound(k, true) - Bound(k, false) + 1) +
+                  Bound(k, false);
+      Sums::Outputs(sums, outputs[s]);
+      for (int o = 0; o < F::kNumOutputs; o++)
+        output_states[o][outputs[s][o]] |= uint64_t(1) << s;
+    }
+  }
+};
+
+/*!
+ * \brief Carry automaton of a function that adds its inputs, as given by its
+ * \see CarrySums.
+ *
+ * The states are the pairs (s, s') of partial sums, starting with zero and
+ * adding one input after the other. A forward pass collects the reachable
+ * states, a backward pass the states that still lead to outputs allowed by
+ * their conditions. A pair of an input is kept if it connects a reachable
+ * state with one that leads to the end. This gives exactly the result of \see
+ * Propagate in the \see Loop (checked by nldpropcheck), but with a few
+ * hundred to a few thousand bit operations instead of up to 4^N times the
+ * number of carry pairs function calls, so the dynamic cache is not needed
+ * for it.
+ *
+ * The states of one s are kept as a bitmask over s'. The steps are unrolled
+ * at compile time, so the offsets and ranges of the \see CarryStates are
+ * constants.
+ */
+template <class F>
+class CarryAutomaton<F, true> {
+ public:
+  static const bool kEnabled = true;
+
+  static BitsliceData<F> Propagate(const BitsliceData<F>& input) {
+    uint64_t forward[F::kNumInputs + 1][kNumStates] = {};
+    uint64_t backward[kNumStates] = {};
+    BitsliceData<F> output;
+
+    // the passes avoid data dependent branches, the conditions are too random
+    // for the branch prediction
+    forward[0][States::kStart] = uint64_t(1) << States::kStart;
+    ForwardPass(input, forward, std::make_index_sequence<F::kNumInputs>());
+
+    // final states with allowed outputs, allowed[o][y] has the states s' with
+    // an output o that is allowed together with the value y of s, reached[o][y]
+    // the allowed states s' of all s with value y
+    uint64_t allowed[F::kNumOutputs][States::kMaxValues] = {};
+    uint64_t reached[F::kNumOutputs][States::kMaxValues] = {};
+    for (int o = 0; o < F::kNumOutputs; o++) {
+      const uint64_t cond = input.GetCondition(F::kNumInputs + o);
+      const int bits = F::Bitsize(F::kNumInputs + o);
+      for (int y = 0; y < 1 << bits; y++)
+        for (int z = 0; z < 1 << bits; z++)
+          allowed[o][y] |= kStates.output_states[o][z] &
+                           -nldtool::GetBit(cond, (z << bits) + y);
+    }
+    for (int s = kStates.begin[F::kNumInputs]; s < kStates.end[F::kNumInputs];
+         s++) {
+      uint64_t states = forward[F::kNumInputs][s];
+      for (int o = 0; o < F::kNumOutputs; o++)
+        states &= allowed[o][kStates.outputs[s][o]];
+      backward[s] = states;
+      for (int o = 0; o < F::kNumOutputs; o++)
+        reached[o][kStates.outputs[s][o]] |= states;
+    }
+    uint64_t outputs_kept[F::kNumOutputs] = {};
+    for (int o = 0; o < F::kNumOutputs; o++) {
+      const int bits = F::Bitsize(F::kNumInputs + o);
+      for (int y = 0; y < 1 << bits; y++)
+        for (int z = 0; z < 1 << bits; z++)
+          outputs_kept[o] |=
+              uint64_t((reached[o][y] & kStates.output_states[o][z]) != 0)
+              << ((z << bits) + y);
+    }
+    // contradiction, all conditions are empty like in the Loop
+    if (!outputs_kept[0]) return output;
+    for (int o = 0; o < F::kNumOutputs; o++)
+      output.SetCondition(F::kNumInputs + o, outputs_kept[o]);
+
+    BackwardPass(input, forward, backward, output,
+                 std::make_index_sequence<F::kNumInputs>());
+    return output;
+  }
+
+ private:
+  typedef CarryStates<F> States;
+  static const int kNumStates = States::kNumStates;
+  static constexpr States kStates = States();
+
+  template <size_t... J>
+  static void ForwardPass(const BitsliceData<F>& input,
+                          uint64_t forward[][kNumStates],
+                          std::index_sequence<J...>) {
+    const int steps[] = {(ForwardStep<J>(input, forward), 0)...};
+    (void)steps;
+  }
+
+  // adds the pairs of the input of step j to the reachable states
+  template <int j>
+  static void ForwardStep(const BitsliceData<F>& input,
+                          uint64_t forward[][kNumStates]) {
+    const int i = States::Input(j);
+    const int bits = F::Bitsize(i);
+    const uint64_t cond = input.GetCondition(i);
+    // the states of a row are collected before they are stored, the carry
+    // input has many pairs but a single row
+    for (int x = 0; x < 1 << bits; x++) {
+      const int d = kStates.offsets[i][x];
+      for (int s = kStates.begin[j]; s < kStates.end[j]; s++) {
+        uint64_t states = 0;
+        for (int y = 0; y < 1 << bits; y++)
+          states |= Shift(forward[j][s], kStates.offsets[i][y]) &
+                    -nldtool::GetBit(cond, (y << bits) + x);
+        forward[j + 1][s + d] |= states;
+      }
+    }
+  }
+
+  template <size_t... J>
+  static void BackwardPass(const BitsliceData<F>& input,
+                           const uint64_t forward[][kNumStates],
+                           uint64_t backward[], BitsliceData<F>& output,
+                           std::index_sequence<J...>) {
+    const int steps[] = {
+        (BackwardStep<F::kNumInputs - 1 - J>(input, forward, backward, output),
+         0)...};
+    (void)steps;
+  }
+
+  // keeps the pairs of the input of step j on a path to the end, and moves
+  // the states that lead to the end back to the step
+  template <int j>
+  static void BackwardStep(const BitsliceData<F>& input,
+                           const uint64_t forward[][kNumStates],
+                           uint64_t backward[], BitsliceData<F>& output) {
+    const int i = States::Input(j);
+    const int bits = F::Bitsize(i);
+    const uint64_t cond = input.GetCondition(i);
+    uint64_t previous[kNumStates] = {};
+    uint64_t kept = 0;
+    for (int x = 0; x < 1 << bits; x++) {
+      const int d = kStates.offsets[i][x];
+      uint64_t used[1 << bits] = {};
+      for (int s = kStates.begin[j]; s < kStates.end[j]; s++) {
+        uint64_t states = 0;
+        for (int y = 0; y < 1 << bits; y++) {
+          const uint64_t next =
+              Shift(backward[s + d], -kStates.offsets[i][y]) &
+              -nldtool::GetBit(cond, (y << bits) + x);
+          states |= next;
+          used[y] |= forward[j][s] & next;
+        }
+        previous[s] |= states;
+      }
+      for (int y = 0; y < 1 << bits; y++)
+        kept |= uint64_t(used[y] != 0) << ((y << bits) + x);
+    }
+    output.SetCondition(i, kept);
+    std::copy(previous, previous + kNumStates, backward);
+  }
+
+  // moves the states of a bitmask by the given offset
+  static uint64_t Shift(uint64_t states, int offset) {
+    return (offset >= 0) ? states << offset : states >> -offset;
+  }
+};
+
+template <class F>
+constexpr CarryStates<F> CarryAutomaton<F, true>::kStates;
+
+/*!
+ * \brief Carry automaton of a modular addition with N inputs.
+ *
+ * The states are the pairs (s, s') of partial sums, starting with the carry
+ * input and adding one input after the other. A forward pass collects the
+ * reachable states, a backward pass the states that still lead to a sum bit
+ * and carry output allowed by their conditions. A pair of an input is kept
+ * if it connects a reachable state with one that leads to the end. This gives
+ * exactly the result of \see Propagate in the \see Loop (checked by
+ * nldpropcheck), but with a few hundred bit operations instead of up to 4^N
+ * times the number of carry pairs function calls, so the dynamic cache is not
+ * needed for it.
+ *
+ * It is the automaton of the other functions for a single sum, specialized
+ * for the 1-bit inputs, which makes it about twice as fast for 5 and 6 inputs.
+ * The states of one partial sum s are kept as a bitmask over s'.
+ */
+template <int N>
+class CarryAutomaton<ADD<N>, true> {
+ public:
+  static const bool kEnabled = true;
+
+  static BitsliceData<ADD<N>> Propagate(const BitsliceData<ADD<N>>& input) {
+    uint32_t forward[N + 1][kNumSums] = {};
+    uint32_t backward[kNumSums] = {};
+    BitsliceData<ADD<N>> output;
+
+    // the passes avoid data dependent branches, the conditions are too
+    // random for the branch prediction
+
+    // forward pass, starting with the carry input
+    const uint64_t carry_in = input.GetCondition(kCarryIn);
+    for (int s = 0; s < kNumCarries; s++)
+      for (int t = 0; t < kNumCarries; t++)
+        forward[0][s] |= nldtool::GetBit(carry_in, t * kNumCarries + s) << t;
+    for (int i = 0; i < N; i++) {
+      uint32_t m[4];
+      PairMasks(input.GetCondition(i), m);
+      // every row only depends on the previous rows, so there is no chain of
+      // stores and loads
+      forward[i + 1][0] =
+          (forward[i][0] & m[0]) | ((forward[i][0] << 1) & m[2]);
+      for (int s = 1; s < kNumSums; s++) {
+        const uint32_t states = forward[i][s];
+        const uint32_t lower = forward[i][s - 1];
+        forward[i + 1][s] = (states & m[0]) | ((states << 1) & m[2]) |
+                            (lower & m[1]) | ((lower << 1) & m[3]);
+      }
+    }
+
+    // final states with an allowed sum bit and carry output
+    const uint64_t sum = input.GetCondition(kSum);
+    const uint64_t carry_out = input.GetCondition(kCarryOut);
+    // the sum bit depends on the parity of the partial sums, the carry output
+    // on both partial sums shifted by one, so rows 2a and 2a + 1 share it
+    const uint32_t sum_allowed[2] = {
+        (-uint32_t(nldtool::GetBit(sum, 0)) & kEven) |
+            (-uint32_t(nldtool::GetBit(sum, 2)) & ~kEven),
+        (-uint32_t(nldtool::GetBit(sum, 1)) & kEven) |
+            (-uint32_t(nldtool::GetBit(sum, 3)) & ~kEven)};
+    uint32_t parity_states[2] = {};
+    uint64_t carry_out_kept = 0;
+    for (int a = 0; 2 * a < kNumSums; a++) {
+      uint32_t allowed = 0;
+      for (int c = 0; c < kNumCarries; c++)
+        allowed |= (3u << (2 * c)) &
+                   -uint32_t(nldtool::GetBit(carry_out, c * kNumCarries + a));
+      uint32_t states = 0;
+      for (int s = 2 * a; s < 2 * a + 2 && s < kNumSums; s++) {
+        backward[s] = forward[N][s] & allowed & sum_allowed[s & 1];
+        parity_states[s & 1] |= backward[s];
+        states |= backward[s];
+      }
+      states = (states | states >> 1) & kEven;
+      for (int c = 0; c < kNumCarries; c++)
+        carry_out_kept |= uint64_t((states >> (2 * c)) & 1)
+                          << (c * kNumCarries + a);
+    }
+    uint64_t sum_kept = 0;
+    for (int p = 0; p < 2; p++)
+      sum_kept |= uint64_t((parity_states[p] & kEven) != 0) << p |
+                  uint64_t((parity_states[p] & ~kEven) != 0) << (2 | p);
+    // contradiction, all conditions are empty like in the Loop
+    if (!sum_kept) return output;
+    output.SetCondition(kSum, sum_kept);
+    output.SetCondition(kCarryOut, carry_out_kept);
+
+    // backward pass, keeping the pairs of the inputs on a path to the end
+    for (int i = N - 1; i >= 0; i--) {
+      uint32_t m[4];
+      PairMasks(input.GetCondition(i), m);
+      uint32_t used[4] = {};
+      for (int s = 0; s < kNumSums - 1; s++) {
+        const uint32_t states = forward[i][s];
+        const uint32_t s0 = backward[s];
+        const uint32_t s1 = backward[s + 1];
+        used[0] |= states & s0;
+        used[1] |= states & s1;
+        used[2] |= states & (s0 >> 1);
+        used[3] |= states & (s1 >> 1);
+        backward[s] = (s0 & m[0]) | (s1 & m[1]) | ((s0 >> 1) & m[2]) |
+                      ((s1 >> 1) & m[3]);
+      }
+      uint64_t kept = 0;
+      for (int p = 0; p < 4; p++) kept |= uint64_t((used[p] & m[p]) != 0) << p;
+      output.SetCondition(i, kept);
+    }
+
+    uint64_t carry_in_kept = 0;
+    for (int s = 0; s < kNumCarries; s++) {
+      const uint32_t states = forward[0][s] & backward[s];
+      for (int t = 0; t < kNumCarries; t++)
+        carry_in_kept |= uint64_t((states >> t) & 1) << (t * kNumCarries + s);
+    }
+    output.SetCondition(kCarryIn, carry_in_kept);
+    return output;
+  }
+
+ private:
+  static const int kCarryIn = N;
+  static const int kSum = N + 1;
+  static const int kCarryOut = N + 2;
+  static const int kNumCarries = 1 << ADD<N>::Bitsize(kCarryIn);
+  // partial sums range from 0 to N + kNumCarries - 1, plus one empty row so
+  // that s + 1 can always be accessed
+  static const int kNumSums = N + kNumCarries + 1;
+  static_assert(kNumSums <= 32, "partial sums have to fit into 32 bits");
+  // the states with an even second partial sum
+  static const uint32_t kEven = 0x55555555;
+
+  // all states for the pairs of a 1-bit condition that are allowed
+  static void PairMasks(uint64_t cond, uint32_t m[4]) {
+    for (int p = 0; p < 4; p++) m[p] = -uint32_t((cond >> p) & 1);
+  }
+};
+
+#endif  // CARRY_AUTOMATON_H_
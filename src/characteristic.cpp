@@ -1,6 +1,8 @@
 #include "characteristic.h"
 
+#include <algorithm>
 #include <cassert>
+#include <fstream>
 #include <iostream>
 
 #include "search.h"
@@ -13,9 +15,10 @@ Characteristic::Characteristic(CryptoPtr crypto)
       bit_conditions3_(crypto_->GetNumWords(3), crypto_->GetWordSize()),
       step_data_(crypto_->GetNumSteps(), (StepData*)0),
       twobit_container_(crypto_),
-      step_update_list_(),
+      step_update_list_(crypto_->GetNumSteps()),
       condition_update_list_(),
       twobit_bitslice_update_mask_(crypto_->GetWordSize()) {
+  crypto_->CompileConditionAccess();
   for (int step = 0; step < crypto_->GetNumSteps(); ++step) {
     step_data_[step] = crypto_->GetStep(step).CreateStepData();
   }
@@ -40,13 +43,12 @@ Characteristic::Characteristic(const Characteristic& s)
 }
 
 Characteristic::~Characteristic() {
-  for (int step = 0; step < crypto_->GetNumSteps(); ++step) {
-    delete step_data_[step];
-  }
+  for (StepData* data : step_data_) delete data;
 }
 
 Characteristic& Characteristic::operator=(const Characteristic& s) {
   assert(crypto_.get() == s.crypto_.get());
+  if (step_data_.empty()) step_data_.resize(crypto_->GetNumSteps(), nullptr);
   bit_conditions_ = s.bit_conditions_;
   bit_conditions2_ = s.bit_conditions2_;
   bit_conditions3_ = s.bit_conditions3_;
@@ -55,51 +57,38 @@ Characteristic& Characteristic::operator=(const Characteristic& s) {
   condition_update_list_ = s.condition_update_list_;
   twobit_bitslice_update_mask_ = s.twobit_bitslice_update_mask_;
   for (int step = 0; step < crypto_->GetNumSteps(); ++step) {
-    if (s.step_data_[step] != 0) {
-      (s.step_data_[step])->Copy(&(step_data_[step]));
-    }
+    if (s.step_data_[step] == nullptr) continue;
+    if (step_data_[step] == nullptr)
+      step_data_[step] = s.step_data_[step]->Clone();
+    else
+      s.step_data_[step]->Copy(&(step_data_[step]));
   }
   return *this;
 }
 
-Characteristic::Characteristic(Characteristic&& s)
+Characteristic::Characteristic(Characteristic&& s) noexcept
     : crypto_(s.crypto_),
-      bit_conditions_(s.bit_conditions_),
-      bit_conditions2_(s.bit_conditions2_),
-      bit_conditions3_(s.bit_conditions3_),
-      step_data_(s.step_data_),
-      twobit_container_(s.twobit_container_),
-      step_update_list_(s.step_update_list_),
-      condition_update_list_(s.condition_update_list_),
-      twobit_bitslice_update_mask_(s.twobit_bitslice_update_mask_) {
-  // do not copy the step data
-  // step_data_.reserve(crypto_->GetNumSteps());
-  for (int step = 0; step < s.crypto_->GetNumSteps(); ++step) {
-    // step_data_[step] = s.step_data_[step];
-    s.step_data_[step] = nullptr;
-  }
-}
-
-Characteristic& Characteristic::operator=(Characteristic&& s) {
-  crypto_ = s.crypto_;
-
-  for (int step = 0; step < crypto_->GetNumSteps(); ++step) {
-    delete step_data_[step];
-  }
-
-  bit_conditions_ = s.bit_conditions_;
-  bit_conditions2_ = s.bit_conditions2_;
-  bit_conditions3_ = s.bit_conditions3_;
-  twobit_container_ = s.twobit_container_;
-  step_update_list_ = std::move(s.step_update_list_);
-  condition_update_list_ = std::move(s.condition_update_list_);
-  twobit_bitslice_update_mask_ = s.twobit_bitslice_update_mask_;
-  // step_data_ = std::move(s.step_data_);
-  step_data_.reserve(crypto_->GetNumSteps());
-  for (int step = 0; step < s.crypto_->GetNumSteps(); ++step) {
-    step_data_[step] = s.step_data_[step];
-    s.step_data_[step] = nullptr;
-  }
+      bit_conditions_(std::move(s.bit_conditions_)),
+      bit_conditions2_(std::move(s.bit_conditions2_)),
+      bit_conditions3_(std::move(s.bit_conditions3_)),
+      step_data_(std::move(s.step_data_)),
+      twobit_container_(std::move(s.twobit_container_)),
+      step_update_list_(std::move(s.step_update_list_)),
+      condition_update_list_(std::move(s.condition_update_list_)),
+      twobit_bitslice_update_mask_(std::move(s.twobit_bitslice_update_mask_)) {
+  s.step_data_.clear();
+}
+
+Characteristic& Characteristic::operator=(Characteristic&& s) noexcept {
+  assert(crypto_.get() == s.crypto_.get());
+  bit_conditions_ = std::move(s.bit_conditions_);
+  bit_conditions2_ = std::move(s.bit_conditions2_);
+  bit_conditions3_ = std::move(s.bit_conditions3_);
+  step_data_.swap(s.step_data_);
+  twobit_container_ = std::move(s.twobit_container_);
+  step_update_list_.Swap(s.step_update_list_);
+  condition_update_list_.swap(s.condition_update_list_);
+  twobit_bitslice_update_mask_ = std::move(s.twobit_bitslice_update_mask_);
   return *this;
 }
 
@@ -249,16 +238,23 @@ uint64_t Characteristic::GetConditionWordMask(
 
 Bitmask Characteristic::GetConditionMask(
     Bitmask mask, const std::function<bool(BitCondition)>& f) const {
-  for (auto x = mask.begin(); x != mask.end(); ++x)
-    x = mask.ClearBits(x, ~GetConditionWordMask(f, x->word));
+  RestrictConditionMask(mask, f);
   return mask;
 }
 
+void Characteristic::RestrictConditionMask(
+    Bitmask& mask, const std::function<bool(BitCondition)>& f) const {
+  for (int word = 0; word < mask.GetNumWords(); ++word)
+    if (mask.GetWordMask(word))
+      mask.ClearBits(word, ~GetConditionWordMask(f, word));
+}
+
 Bitmask Characteristic::GetConditionMask(
     const std::function<bool(BitCondition)>& f) const {
   Bitmask mask(crypto_->GetWordSize());
-  for (auto x = mask.begin(); x != mask.end(); ++x)
-    x = mask.SetBits(x, GetConditionWordMask(f, x->word));
+  for (int word = 0; word < mask.GetNumWords(); ++word)
+    if (mask.GetWordMask(word))
+      mask.SetBits(word, GetConditionWordMask(f, word));
   return mask;
 }
 
@@ -281,10 +277,18 @@ bool Characteristic::Complete(const std::function<bool(BitCondition)>& f) {
 bool Characteristic::Complete(const std::function<bool(BitCondition)>& f,
                               const Bitmask& mask) {
   Characteristic tmp = *this;
+  Bitmask todo;
+  return Complete(f, mask, tmp, todo);
+}
+
+bool Characteristic::Complete(const std::function<bool(BitCondition)>& f,
+                              const Bitmask& mask, Characteristic& tmp,
+                              Bitmask& todo) {
   bool changed, results[2];
   do {
     changed = false;
-    Bitmask todo = GetConditionMask(mask, f);
+    todo = mask;
+    RestrictConditionMask(todo, f);
     while (!todo.Empty()) {
       const Bitpos p = todo.First();
       const uint8_t c = GetBitCondition(p);
@@ -293,7 +297,7 @@ bool Characteristic::Complete(const std::function<bool(BitCondition)>& f,
         tmp.ShallowCopy(*this);
         tmp.SetBitCondition(p, BitCondition(Search::CHOICES[c].bc[i]));
         results[i] = tmp.Update(true);
-        todo = tmp.GetConditionMask(todo, f);
+        tmp.RestrictConditionMask(todo, f);
         tmp.Undo();
       }
       // continue, return or redo:
@@ -311,21 +315,29 @@ bool Characteristic::Complete(const std::function<bool(BitCondition)>& f,
 }
 
 bool Characteristic::Update(bool backtrack, int32_t priority) {
-  while (!step_update_list_.empty()) {
-    const StepUpdate pos = *step_update_list_.begin();
+  int prefetched_step = -1;
+  while (!step_update_list_.Empty()) {
+    // pos stays queued during its own update, so touching it is ignored
+    const StepUpdate pos = step_update_list_.Pop();
     if (pos.priority > priority) {
-      step_update_list_.erase(pos);
+      step_update_list_.Release(pos);
       continue;
     }
-    if (!crypto_->GetStep(pos.step).Update(*this, pos.bit, backtrack)) {
-      step_update_list_.erase(pos);
-      return false;
+    // the queued bits of a step are popped one after another, so prefetch
+    // the cache entries of the other bits while updating the first one
+    if (pos.step != prefetched_step) {
+      prefetched_step = pos.step;
+      const uint64_t bits = step_update_list_.GetQueuedBits(pos.step) &
+                            ~(1ull << pos.bit);
+      if (bits) crypto_->GetStep(pos.step).Prefetch(*this, bits);
     }
-    step_update_list_.erase(pos);
+    const bool result =
+        crypto_->GetStep(pos.step).Update(*this, pos.bit, backtrack);
+    step_update_list_.Release(pos);
+    if (!result) return false;
     // FIXME: improve performance of LinearConditions::PropagateConditions and
     // remove the following hack
-    if (step_update_list_.empty() ||
-        (*step_update_list_.begin()).step != pos.step)
+    if (step_update_list_.Empty() || step_update_list_.Top().step != pos.step)
       if (!crypto_->GetStep(pos.step).PropagateConditions(*this)) {
         return false;
       }
@@ -333,21 +345,15 @@ bool Characteristic::Update(bool backtrack, int32_t priority) {
   return true;
 }
 
-void Characteristic::Touch(const ConditionProxy& cp) {
-  for (auto pos : cp.GetStepsToUpdate()) {
-    step_update_list_.insert(pos);
-    if (crypto_->GetStep(pos.step).GetName().compare("LinearStep") != 0)
-      twobit_bitslice_update_mask_.SetBit(Bitpos(pos.step, pos.bit));
-  }
-}
-
 bool Characteristic::UpdateAll() {
-  for (int word = 0; word < crypto_->GetNumWords(); word++)
-    for (int bit = 0; bit < crypto_->GetWordSize(); bit++)
-      Touch(*(crypto_->GetConditionProxy(Bitpos(word, bit)).get()));
+  TouchAll();
   return Update();
 }
 
+void Characteristic::TouchAll() {
+  for (int row = 0; row < crypto_->GetNumTouchRows(); row++) TouchRow(row);
+}
+
 int Characteristic::CheckCharacteristic(Logfile& logfile, int check_level,
                                         bool print_characteristic) {
   if (print_characteristic) {
@@ -466,4 +472,161 @@ void Characteristic::WriteCharacteristic(std::ostream& fs) {
 
 void Characteristic::WriteCharacteristic(Logfile& logfile) {
   WriteCharacteristic(logfile.getStream());
+  logfile << std::flush;
+}
+
+namespace {
+
+const char kBinaryMagic[4] = {'N', 'L', 'D', 'C'};
+const uint8_t kBinaryVersion = 1;
+
+template <typename T>
+void PutLE(std::vector<char>& buf, T value, int bytes = sizeof(T)) {
+  for (int i = 0; i < bytes; ++i) buf.push_back((char)(value >> (8 * i)));
+}
+
+template <typename T>
+T GetLE(const char* p, int bytes = sizeof(T)) {
+  T value = 0;
+  for (int i = 0; i < bytes; ++i) value |= ((T)(uint8_t)p[i]) << (8 * i);
+  return value;
+}
+
+template <typename T>
+void PutContainer(std::vector<char>& buf, const ConditionContainer<T>& c,
+                  int bytes) {
+  for (int word = 0; word < c.GetNumWords(); ++word) {
+    const T* conditions = c.GetWordPtr(word);
+    for (int bit = 0; bit < c.GetWordSize(); ++bit)
+      PutLE(buf, (uint64_t)conditions[bit], bytes);
+  }
+}
+
+template <typename T>
+const char* GetContainer(const char* p, ConditionContainer<T>& c, int bytes) {
+  for (int word = 0; word < c.GetNumWords(); ++word) {
+    T* conditions = c.GetWordPtr(word);
+    for (int bit = 0; bit < c.GetWordSize(); ++bit, p += bytes)
+      conditions[bit] = T(GetLE<uint64_t>(p, bytes));
+  }
+  return p;
+}
+
+}  // namespace
+
+bool Characteristic::WriteBinary(std::ostream& fs) const {
+  const std::string& name = crypto_->GetName();
+  const int word_size = crypto_->GetWordSize();
+  const int num_words1 = bit_conditions_.GetNumWords();
+  std::vector<char> buf;
+  buf.reserve(24 + name.size() + (num_words1 * word_size + 1) / 2 +
+              (2 * bit_conditions2_.GetNumWords() +
+               8 * bit_conditions3_.GetNumWords()) *
+                  word_size);
+  buf.insert(buf.end(), kBinaryMagic, kBinaryMagic + 4);
+  PutLE(buf, kBinaryVersion);
+  PutLE(buf, (uint8_t)name.size());
+  buf.insert(buf.end(), name.begin(), name.begin() + (uint8_t)name.size());
+  PutLE(buf, (uint16_t)word_size);
+  PutLE(buf, (uint32_t)crypto_->GetNumRounds());
+  PutLE(buf, (uint32_t)num_words1);
+  PutLE(buf, (uint32_t)bit_conditions2_.GetNumWords());
+  PutLE(buf, (uint32_t)bit_conditions3_.GetNumWords());
+
+  // two 1-bit conditions per byte, low nibble first
+  uint8_t byte = 0;
+  int nibbles = 0;
+  for (int word = 0; word < num_words1; ++word) {
+    const BitCondition* conditions = bit_conditions_.GetWordPtr(word);
+    for (int bit = 0; bit < word_size; ++bit) {
+      byte |= ((uint8_t)conditions[bit]) << (4 * (nibbles & 1));
+      if (++nibbles & 1) continue;
+      buf.push_back((char)byte);
+      byte = 0;
+    }
+  }
+  if (nibbles & 1) buf.push_back((char)byte);
+
+  PutContainer(buf, bit_conditions2_, 2);
+  PutContainer(buf, bit_conditions3_, 8);
+
+  fs.write(buf.data(), buf.size());
+  return !fs.fail();
+}
+
+bool Characteristic::WriteBinary(std::string file) const {
+  std::ofstream stream(file.c_str(), std::ios::out | std::ios::binary);
+  if (stream.fail()) {
+    std::cerr << "error: writing file '" << file << "'" << std::endl;
+    return false;
+  }
+  return WriteBinary(stream);
+}
+
+bool Characteristic::ReadBinary(std::istream& fs) {
+  char header[6];
+  if (!fs.read(header, sizeof(header)) ||
+      !std::equal(kBinaryMagic, kBinaryMagic + 4, header)) {
+    std::cerr << "error: not a binary characteristic" << std::endl;
+    return false;
+  }
+  if ((uint8_t)header[4] != kBinaryVersion) {
+    std::cerr << "error: unsupported binary characteristic version "
+              << (int)(uint8_t)header[4] << std::endl;
+    return false;
+  }
+  std::string name((uint8_t)header[5], ' ');
+  char info[18];
+  if (!fs.read(&name[0], name.size()) || !fs.read(info, sizeof(info))) {
+    std::cerr << "error: truncated binary characteristic" << std::endl;
+    return false;
+  }
+  const int word_size = GetLE<uint16_t>(info);
+  const int num_rounds = GetLE<uint32_t>(info + 2);
+  const int num_words1 = GetLE<uint32_t>(info + 6);
+  const int num_words2 = GetLE<uint32_t>(info + 10);
+  const int num_words3 = GetLE<uint32_t>(info + 14);
+  if ((!crypto_->GetName().empty() && name != crypto_->GetName()) ||
+      num_rounds != crypto_->GetNumRounds() ||
+      word_size != crypto_->GetWordSize() ||
+      num_words1 != bit_conditions_.GetNumWords() ||
+      num_words2 != bit_conditions2_.GetNumWords() ||
+      num_words3 != bit_conditions3_.GetNumWords()) {
+    std::cerr << "error: binary characteristic of " << name << " ("
+              << num_rounds << " rounds, word size " << word_size
+              << ") does not match the current configuration" << std::endl;
+    return false;
+  }
+
+  std::vector<char> buf((num_words1 * word_size + 1) / 2 +
+                        (2 * num_words2 + 8 * num_words3) * word_size);
+  if (!fs.read(buf.data(), buf.size())) {
+    std::cerr << "error: truncated binary characteristic" << std::endl;
+    return false;
+  }
+  const char* p = buf.data();
+  int nibbles = 0;
+  for (int word = 0; word < num_words1; ++word) {
+    BitCondition* conditions = bit_conditions_.GetWordPtr(word);
+    for (int bit = 0; bit < word_size; ++bit, ++nibbles) {
+      const uint8_t byte = p[nibbles / 2];
+      conditions[bit] = BitCondition((byte >> (4 * (nibbles & 1))) & 0xf);
+    }
+  }
+  p += (nibbles + 1) / 2;
+  p = GetContainer(p, bit_conditions2_, 2);
+  GetContainer(p, bit_conditions3_, 8);
+
+  // the containers were written directly, so all steps have to be updated
+  TouchAll();
+  return true;
+}
+
+bool Characteristic::ReadBinary(std::string file) {
+  std::ifstream stream(file.c_str(), std::ios::in | std::ios::binary);
+  if (stream.fail()) {
+    std::cerr << "error: reading file '" << file << "'" << std::endl;
+    return false;
+  }
+  return ReadBinary(stream);
 }
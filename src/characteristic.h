@@ -8,11 +8,14 @@
 #include "bitmask.h"
 #include "bitpos.h"
 #include "condition.h"
+#include "condition_access.h"
 #include "condition_container.h"
+#include "condition_proxy.h"
 #include "crypto.h"
 #include "logfile.h"
 #include "step_data.h"
 #include "step_update.h"
+#include "step_update_queue.h"
 #include "twobit_container.h"
 
 /*!
@@ -30,9 +33,10 @@ class Characteristic {
   Characteristic(CryptoPtr crypto);
   Characteristic(const Characteristic& s);
   Characteristic& operator=(const Characteristic& s);
-  // move operators
-  Characteristic(Characteristic&& s);
-  Characteristic& operator=(Characteristic&& s);
+  // the move constructor takes over all buffers of s, which can afterwards
+  // only be destroyed or assigned to; the move assignment swaps the buffers
+  Characteristic(Characteristic&& s) noexcept;
+  Characteristic& operator=(Characteristic&& s) noexcept;
   virtual ~Characteristic();
   void ShallowCopy(const Characteristic& s);
   void Undo();
@@ -65,6 +69,43 @@ class Characteristic {
     return value != Condition<3>(0);
   }
 
+  // direct access via the compiled tables, \see ConditionAccess
+  uint64_t GetCondition(const ConditionAccess& access) const {
+    switch (access.kind) {
+      case ConditionAccess::CONTAINER:
+        if (access.num_bits == 1)
+          return bit_conditions_.GetCondition(access.container_pos);
+        if (access.num_bits == 2)
+          return bit_conditions2_.GetCondition(access.container_pos);
+        return bit_conditions3_.GetCondition(access.container_pos);
+      case ConditionAccess::KONSTANT:
+        return access.konstant;
+      default:
+        return access.proxy->GetCondition(*this);
+    }
+  }
+
+  // same semantics as ConditionProxy::SetCondition
+  bool SetCondition(const ConditionAccess& access, uint64_t value) {
+    switch (access.kind) {
+      case ConditionAccess::CONTAINER:
+        if (GetCondition(access) == value) return true;
+        Touch(access);
+        if (access.num_bits == 1)
+          return SetContainerCondition1(access.container_pos,
+                                        BitCondition(value));
+        if (access.num_bits == 2)
+          return SetContainerCondition2(access.container_pos,
+                                        Condition<2>(value));
+        return SetContainerCondition3(access.container_pos,
+                                      Condition<3>(value));
+      case ConditionAccess::KONSTANT:
+        return (access.konstant & value) == value;
+      default:
+        return access.proxy->SetCondition(*this, value);
+    }
+  }
+
   BitCondition GetBitCondition(Bitpos condition_mask_pos) const;
 
   bool SetBitCondition(Bitpos condition_mask_pos, BitCondition value);
@@ -86,6 +127,9 @@ class Characteristic {
   Bitmask GetConditionMask(Bitmask mask,
                            const std::function<bool(BitCondition)>& f) const;
   Bitmask GetConditionMask(const std::function<bool(BitCondition)>& f) const;
+  // in place variant of GetConditionMask, which reuses the storage of mask
+  void RestrictConditionMask(Bitmask& mask,
+                             const std::function<bool(BitCondition)>& f) const;
   std::vector<Bitpos> GetBitConditionList(int word, BitCondition value) const;
 
   void SetBit(const std::string& name, int step, int bit, bool a, bool b);
@@ -95,10 +139,31 @@ class Characteristic {
 
   bool Update(bool backtrack = false, int32_t priority = 10000);
   bool UpdateAll();
-  void Touch(const ConditionProxy& cp);
+  void TouchAll();
+
+  // queues the steps depending on a container condition for the next update
+  void TouchContainer(int num_bits, Bitpos container_pos) {
+    TouchRow(crypto_->GetTouchRow(num_bits, container_pos));
+  }
+
+  void Touch(const ConditionAccess& access) { TouchRow(access.touch_row); }
+
+  void TouchRow(int row) {
+    const int* offsets = crypto_->GetStepTouchOffsets();
+    const StepTouch* touch = crypto_->GetStepTouchList();
+    for (int i = offsets[row]; i < offsets[row + 1]; ++i) {
+      step_update_list_.Push(touch[i].update);
+      if (touch[i].twobit)
+        twobit_bitslice_update_mask_.SetBit(
+            Bitpos(touch[i].update.step, touch[i].update.bit));
+    }
+  }
   bool Complete(const std::function<bool(BitCondition)>& f);
   bool Complete(const std::function<bool(BitCondition)>& f,
                 const Bitmask& mask);
+  // tmp and todo are scratch buffers, which are overwritten
+  bool Complete(const std::function<bool(BitCondition)>& f,
+                const Bitmask& mask, Characteristic& tmp, Bitmask& todo);
 
   // checkLevel 1: update
   // checkLevel 2: complete on all 2-bit conditions
@@ -120,6 +185,13 @@ class Characteristic {
   void WriteCharacteristic(std::ostream& fs);
   void WriteCharacteristic(Logfile& logfile);
 
+  // compact binary format: header (crypto name, word size, rounds, number of
+  // words), 4 bits per 1-bit condition, raw 2-bit and 3-bit conditions
+  bool ReadBinary(std::istream& fs);
+  bool ReadBinary(std::string file);
+  bool WriteBinary(std::ostream& fs) const;
+  bool WriteBinary(std::string file) const;
+
  private:
   CryptoPtr crypto_;
 
@@ -130,7 +202,7 @@ class Characteristic {
 
   TwobitContainer twobit_container_;
 
-  std::set<StepUpdate> step_update_list_;
+  StepUpdateQueue step_update_list_;
   std::set<Bitpos, std::less<Bitpos>> condition_update_list_;
   Bitmask twobit_bitslice_update_mask_;
 };
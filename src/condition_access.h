@@ -0,0 +1,43 @@
+#ifndef CONDITION_ACCESS_H_
+#define CONDITION_ACCESS_H_
+
+#include <cstdint>
+
+#include "bitpos.h"
+#include "step_update.h"
+
+class ConditionProxy;
+
+/*!
+ * \brief Resolved access to the condition of one step parameter at one bit.
+ *
+ * The entries are compiled once from the condition proxies by \see
+ * Crypto::CompileConditionAccess. Container and constant conditions are then
+ * read and written directly by the \see Characteristic, without copying the
+ * shared pointer or calling the virtual proxy interface. All other proxies
+ * (e.g. virtual proxies spanning several containers) use the proxy.
+ */
+struct ConditionAccess {
+  enum Kind : uint8_t { CONTAINER, KONSTANT, PROXY };
+
+  Kind kind;
+  uint8_t num_bits;
+  Bitpos container_pos;
+  uint64_t konstant;
+  const ConditionProxy* proxy;
+  // row of the container in the step dependency graph, \see
+  // Crypto::GetTouchRow
+  int touch_row;
+};
+
+/*!
+ * \brief A step (bit) to update after a condition changed, and whether it
+ * also has to be marked for updating the two-bit conditions (i.e. it is not a
+ * \see LinearStep).
+ */
+struct StepTouch {
+  StepUpdate update;
+  bool twobit;
+};
+
+#endif  // CONDITION_ACCESS_H_
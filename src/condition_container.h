@@ -4,6 +4,7 @@
 #include <cassert>
 #include <cmath>
 #include <functional>
+#include <utility>
 #include <vector>
 
 #include "bitpos.h"
@@ -33,18 +34,38 @@ class ConditionContainer {
            sizeof(T) * (num_words_ << log_of_word_size_));
   }
 
+  // takes over the conditions, c is left without any (it can only be
+  // destroyed or assigned to)
+  ConditionContainer(ConditionContainer&& c) noexcept
+      : num_words_(c.num_words_),
+        word_size_(c.word_size_),
+        log_of_word_size_(c.log_of_word_size_),
+        conditions_(c.conditions_) {
+    c.conditions_ = nullptr;
+  }
+
   virtual ~ConditionContainer() { delete[] conditions_; }
 
   ConditionContainer& operator=(const ConditionContainer& c) {
     assert(num_words_ == c.num_words_);
     assert(word_size_ == c.word_size_);
     assert(log_of_word_size_ == c.log_of_word_size_);
-    assert(conditions_ != 0);
+    if (conditions_ == nullptr)
+      conditions_ = new T[num_words_ << log_of_word_size_];
     memcpy(conditions_, c.conditions_,
            sizeof(T) * (num_words_ << log_of_word_size_));
     return *this;
   }
 
+  // swaps the conditions, so the buffer of this container is reused by c
+  ConditionContainer& operator=(ConditionContainer&& c) noexcept {
+    assert(num_words_ == c.num_words_);
+    assert(word_size_ == c.word_size_);
+    assert(log_of_word_size_ == c.log_of_word_size_);
+    std::swap(conditions_, c.conditions_);
+    return *this;
+  }
+
   virtual void SetCondition(const Bitpos& pos, const T& condition) {
     const int index = pos.GetWord() << log_of_word_size_ | pos.GetBit();
     assert(0 <= pos.GetWord() && pos.GetWord() < num_words_);
@@ -61,6 +82,21 @@ class ConditionContainer {
     return conditions_[index];
   }
 
+  int GetNumWords() const { return num_words_; }
+
+  int GetWordSize() const { return word_size_; }
+
+  // direct access to the word_size_ conditions of one word (for bulk I/O)
+  T* GetWordPtr(int word) {
+    assert(0 <= word && word < num_words_);
+    return conditions_ + (word << log_of_word_size_);
+  }
+
+  const T* GetWordPtr(int word) const {
+    assert(0 <= word && word < num_words_);
+    return conditions_ + (word << log_of_word_size_);
+  }
+
   virtual uint64_t GetConditionMask(int word, const T& condition) const {
     assert(0 <= word && word < num_words_);
     const int word_index = word << log_of_word_size_;
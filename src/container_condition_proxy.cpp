@@ -27,6 +27,10 @@ Bitpos ContainerConditionProxy::GetContainerPos() const {
   return container_pos_;
 }
 
+void ContainerConditionProxy::Touch(Characteristic& characteristic) const {
+  characteristic.TouchContainer(num_bits_, container_pos_);
+}
+
 std::string ContainerConditionProxy::ToString() const {
   std::ostringstream oss;
   oss << "S" << num_bits_ << container_pos_ << condition_mask_pos_;
@@ -87,7 +91,7 @@ bool ContainerConditionProxy::SetCondition(Characteristic& characteristic,
                                            uint64_t value) const {
   // assert(GetCondition(characteristic));
   if (GetCondition(characteristic) == value) return true;
-  characteristic.Touch(*this);
+  Touch(characteristic);
   if (num_bits_ == 1)
     return characteristic.SetContainerCondition1(container_pos_,
                                                  Condition<1>(value));
@@ -107,42 +111,42 @@ bool ContainerConditionProxy::SetCondition1(Characteristic& characteristic,
   if (num_bits_ == 1 && start == 0) {
     const Condition<1> old_cond(
         characteristic.GetContainerCondition1(container_pos_));
-    if (old_cond != cond) characteristic.Touch(*this);
+    if (old_cond != cond) Touch(characteristic);
     return characteristic.SetContainerCondition1(container_pos_, cond);
   } else if (num_bits_ == 2 && start == 0) {
     Condition<2> old_cond(
         characteristic.GetContainerCondition2(container_pos_));
     Condition<2> new_cond(old_cond);
     new_cond.MergeBit0(cond);
-    if (old_cond != new_cond) characteristic.Touch(*this);
+    if (old_cond != new_cond) Touch(characteristic);
     return characteristic.SetContainerCondition2(container_pos_, new_cond);
   } else if (num_bits_ == 2 && start == 1) {
     Condition<2> old_cond(
         characteristic.GetContainerCondition2(container_pos_));
     Condition<2> new_cond(old_cond);
     new_cond.MergeBit1(cond);
-    if (old_cond != new_cond) characteristic.Touch(*this);
+    if (old_cond != new_cond) Touch(characteristic);
     return characteristic.SetContainerCondition2(container_pos_, new_cond);
   } else if (num_bits_ == 3 && start == 0) {
     Condition<3> old_cond(
         characteristic.GetContainerCondition3(container_pos_));
     Condition<3> new_cond(old_cond);
     new_cond.MergeBit0(cond);
-    if (old_cond != new_cond) characteristic.Touch(*this);
+    if (old_cond != new_cond) Touch(characteristic);
     return characteristic.SetContainerCondition3(container_pos_, new_cond);
   } else if (num_bits_ == 3 && start == 1) {
     Condition<3> old_cond(
         characteristic.GetContainerCondition3(container_pos_));
     Condition<3> new_cond(old_cond);
     new_cond.MergeBit1(cond);
-    if (old_cond != new_cond) characteristic.Touch(*this);
+    if (old_cond != new_cond) Touch(characteristic);
     return characteristic.SetContainerCondition3(container_pos_, new_cond);
   } else if (num_bits_ == 3 && start == 2) {
     Condition<3> old_cond(
         characteristic.GetContainerCondition3(container_pos_));
     Condition<3> new_cond(old_cond);
     new_cond.MergeBit2(cond);
-    if (old_cond != new_cond) characteristic.Touch(*this);
+    if (old_cond != new_cond) Touch(characteristic);
     return characteristic.SetContainerCondition3(container_pos_, new_cond);
   }
   assert(!"bit index error");
@@ -155,21 +159,21 @@ bool ContainerConditionProxy::SetCondition2(Characteristic& characteristic,
   if (num_bits_ == 2 && start == 0) {
     Condition<2> old_cond(
         characteristic.GetContainerCondition2(container_pos_));
-    if (old_cond != cond) characteristic.Touch(*this);
+    if (old_cond != cond) Touch(characteristic);
     return characteristic.SetContainerCondition2(container_pos_, cond);
   } else if (num_bits_ == 3 && start == 0) {
     Condition<3> old_cond(
         characteristic.GetContainerCondition3(container_pos_));
     Condition<3> new_cond(old_cond);
     new_cond.MergeBits01(cond);
-    if (old_cond != new_cond) characteristic.Touch(*this);
+    if (old_cond != new_cond) Touch(characteristic);
     return characteristic.SetContainerCondition3(container_pos_, new_cond);
   } else if (num_bits_ == 3 && start == 1) {
     Condition<3> old_cond(
         characteristic.GetContainerCondition3(container_pos_));
     Condition<3> new_cond(old_cond);
     new_cond.MergeBits12(cond);
-    if (old_cond != new_cond) characteristic.Touch(*this);
+    if (old_cond != new_cond) Touch(characteristic);
     return characteristic.SetContainerCondition3(container_pos_, new_cond);
   }
   assert(!"bit index error");
@@ -182,7 +186,7 @@ bool ContainerConditionProxy::SetCondition3(Characteristic& characteristic,
   if (num_bits_ == 3 && start == 0) {
     Condition<3> old_cond(
         characteristic.GetContainerCondition3(container_pos_));
-    if (old_cond != cond) characteristic.Touch(*this);
+    if (old_cond != cond) Touch(characteristic);
     return characteristic.SetContainerCondition3(container_pos_, cond);
   }
   assert(!"bit index error");
@@ -49,6 +49,9 @@ class ContainerConditionProxy : public MaskConditionProxy,
   virtual std::string ToString() const;
 
  protected:
+  // queues the steps depending on this container condition
+  void Touch(Characteristic& characteristic) const;
+
   Bitpos container_pos_;
   std::set<StepUpdate> step_update_list_;
 };
@@ -1,7 +1,11 @@
 #include "crypto.h"
 
+#include <set>
+
 #include "characteristic.h"
+#include "container_condition_proxy.h"
 #include "horizontal_condition_word.h"
+#include "konstant_condition_proxy.h"
 #include "linkable_condition_proxy.h"
 #include "mask_condition_proxy.h"
 
@@ -15,6 +19,8 @@ Crypto::Crypto(int word_size) {
   word_size_ = word_size;
   word_mask_ = nldtool::Mask(word_size);
   text_io_format_ = new TextIOFormat();
+  num_rounds_ = 0;
+  num_compiled_steps_ = -1;
   num_words_[0] = 0;
   num_words_[1] = 0;
   num_words_[2] = 0;
@@ -95,6 +101,60 @@ Step* Crypto::Add(Step* step, Step::Priority priority) {
   return step;
 }
 
+void Crypto::CompileConditionAccess() {
+  if (num_compiled_steps_ == steps_.size()) return;
+  CompileStepDependencies();
+  for (Step* step : steps_) step->CompileConditionAccess(*this);
+  num_compiled_steps_ = steps_.size();
+}
+
+void Crypto::CompileStepDependencies() {
+  int num_rows = 0;
+  for (int num_bits = 1; num_bits < 4; ++num_bits) {
+    touch_row_base_[num_bits] = num_rows;
+    num_rows += num_words_[num_bits] * word_size_;
+  }
+  // collect the steps to update of all container condition proxies
+  std::vector<std::set<StepUpdate>> rows(num_rows);
+  for (const ConditionWordPtr& word : words_)
+    for (int bit = 0; bit < word_size_; ++bit) {
+      const ContainerConditionProxy* ccp =
+          dynamic_cast<const ContainerConditionProxy*>(
+              word->GetConditionProxy(bit).get());
+      if (!ccp) continue;
+      std::set<StepUpdate>& row =
+          rows[GetTouchRow(ccp->GetNumBits(), ccp->GetContainerPos())];
+      for (const StepUpdate& pos : ccp->GetStepsToUpdate()) row.insert(pos);
+    }
+  // and store them as compressed sparse rows
+  step_touch_offsets_.clear();
+  step_touch_list_.clear();
+  for (const std::set<StepUpdate>& row : rows) {
+    step_touch_offsets_.push_back(step_touch_list_.size());
+    for (const StepUpdate& pos : row)
+      step_touch_list_.push_back({pos, !steps_[pos.step]->IsLinearStep()});
+  }
+  step_touch_offsets_.push_back(step_touch_list_.size());
+}
+
+ConditionAccess Crypto::CompileConditionAccess(const ConditionProxy& cp) {
+  ConditionAccess access;
+  access.kind = ConditionAccess::PROXY;
+  access.num_bits = cp.GetNumBits();
+  access.konstant = 0;
+  access.proxy = &cp;
+  access.touch_row = -1;
+  if (auto ccp = dynamic_cast<const ContainerConditionProxy*>(&cp)) {
+    access.kind = ConditionAccess::CONTAINER;
+    access.container_pos = ccp->GetContainerPos();
+    access.touch_row = GetTouchRow(access.num_bits, access.container_pos);
+  } else if (auto kcp = dynamic_cast<const KonstantConditionProxy*>(&cp)) {
+    access.kind = ConditionAccess::KONSTANT;
+    access.konstant = kcp->GetKonstant();
+  }
+  return access;
+}
+
 void Crypto::SetupOtherWords() {
   ConditionWordPtr word;
   int w;
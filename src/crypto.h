@@ -4,10 +4,12 @@
 #include <cstdint>
 #include <map>
 #include <regex>
+#include <string>
 #include <vector>
 
 #include "bitmask.h"
 #include "bitpos.h"
+#include "condition_access.h"
 #include "condition_word.h"
 #include "cxxopts.hpp"
 #include "logfile.h"
@@ -72,10 +74,33 @@ class Crypto {
 
   int GetWordSize() const { return word_size_; }
 
+  // compiles the step dependency graph and the flattened condition access
+  // tables of all steps; does nothing if no step has been added since
+  void CompileConditionAccess();
+  ConditionAccess CompileConditionAccess(const ConditionProxy& cp);
+
+  // the step dependency graph: the steps (bits) to update if the container
+  // condition of a row changes are stored in the compressed sparse row
+  // GetStepTouchList()[GetStepTouchOffsets()[row] ... [row + 1] - 1]
+  int GetTouchRow(int num_bits, Bitpos container_pos) const {
+    assert(1 <= num_bits && num_bits < 4);
+    return touch_row_base_[num_bits] + container_pos.GetWord() * word_size_ +
+           container_pos.GetBit();
+  }
+  int GetNumTouchRows() const { return step_touch_offsets_.size() - 1; }
+  const int* GetStepTouchOffsets() const { return step_touch_offsets_.data(); }
+  const StepTouch* GetStepTouchList() const { return step_touch_list_.data(); }
+
   uint64_t GetWordMask() const { return word_mask_; }
 
   TextIOFormat* GetTextIOFormat() const { return text_io_format_; }
 
+  // name and number of rounds as selected by the user (used in binary dumps)
+  void SetName(const std::string& name) { name_ = name; }
+  const std::string& GetName() const { return name_; }
+  void SetNumRounds(int num_rounds) { num_rounds_ = num_rounds; }
+  int GetNumRounds() const { return num_rounds_; }
+
   Bitmask GetWordMaskMain() const;
   Bitmask GetConditionWordMaskRegex(const std::regex& name_regex) const;
   Bitmask GetConditionWordIntervalMaskRegex(const std::regex& name_regex,
@@ -96,6 +121,15 @@ class Crypto {
 
   uint64_t word_mask_;
   TextIOFormat* text_io_format_;
+  std::string name_;
+  int num_rounds_;
+
+  void CompileStepDependencies();
+
+  int touch_row_base_[4];
+  std::vector<int> step_touch_offsets_;
+  std::vector<StepTouch> step_touch_list_;
+  int num_compiled_steps_;
 
   typedef std::pair<std::string, int> WordHandle;
   std::map<WordHandle, int> word_handle_to_index_;
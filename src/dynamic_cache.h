@@ -1,61 +1,140 @@
 #ifndef DYNAMIC_CACHE_H_
 #define DYNAMIC_CACHE_H_
 
+// log2 of the maximum number of slots of a dynamic cache
 #ifndef MAX_DYNAMIC_CACHE_SIZE
-#define MAX_DYNAMIC_CACHE_SIZE 22
+#define MAX_DYNAMIC_CACHE_SIZE 24
 #endif
 
+// log2 of the number of slots of the direct-mapped table in front of a
+// dynamic cache
+#ifndef RECENT_CACHE_SIZE
+#define RECENT_CACHE_SIZE 12
+#endif
+
+static_assert(RECENT_CACHE_SIZE > 0 && RECENT_CACHE_SIZE < 64,
+              "RECENT_CACHE_SIZE has to be between 1 and 63");
+
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <fstream>
 #include <iostream>
-#include <list>
-#include <unordered_map>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "cache_base.h"
+#include "huge_page_allocator.h"
 
 /*!
- * \brief The dynamic version of the cache, using a std::unordered_map.
+ * \brief The dynamic version of the cache, using an open-addressing hash
+ * table.
  *
  * In this dynamic cache, the results are calculated when they are needed, and
- * stored in the cache for later access. The std::unordered_map's implementation
- * is a great performance gain for our case when compared to a std::map. The
- * maximum capacity of the dynamic cache is controlled via the define
- * MAX_DYNAMIC_CACHE_SIZE.
+ * stored in the cache for later access. The keys, values and probe distances
+ * are stored inline in flat arrays (Robin Hood hashing with linear probing),
+ * so a lookup usually touches a single cache line of keys. The table grows
+ * up to 2^MAX_DYNAMIC_CACHE_SIZE slots and is filled up to 7/8. Then every
+ * insertion evicts an entry, which approximates LRU with one use count per
+ * slot: the entries in the first 8 occupied slots from the home slot of the
+ * new key are compared, the least used one is evicted and the counts of the
+ * others are decremented. The tables are allocated with the
+ * \see HugePageAllocator, since the probes are random accesses.
+ *
+ * A small direct-mapped table of recently used entries is checked first. A
+ * hit there costs a single compare of the key, without walking the probe
+ * sequence of the large table and its TLB and cache misses. It remembers the
+ * slot of each entry in the large table, so its hits still set the use count
+ * there if the entry has not moved or been evicted since.
+ *
+ * After the first snapshot, the inserted entries are also kept serialized, so
+ * the next snapshot only appends them to the dump file. The dumps of other
+ * runs can be merged in. The use count of an entry is then the number of
+ * dumps that contain it, so the entries common to several runs are evicted
+ * last. Hits in the search set the count to at least 1.
  */
 template <class Key, class Data>
 class DynamicCache : public CacheBase<Key, Data> {
  public:
-  DynamicCache() { capacity_ = 1ull << MAX_DYNAMIC_CACHE_SIZE; }
+  DynamicCache() : max_slots_(1ull << MAX_DYNAMIC_CACHE_SIZE) {}
 
   virtual ~DynamicCache() {}
 
   virtual void Insert(const Key key, const Data value) {
-    if (data_.size() == capacity_) Evict();
-    ListIt it = lru_data_.insert(lru_data_.begin(), key);
-    std::pair<CacheMapIt, bool> pp =
-        data_.insert(typename CacheMap::value_type(key, make_pair(value, it)));
-    if (pp.second == false) lru_data_.pop_front();
+    if (recent_.empty()) recent_.resize(1ull << RECENT_CACHE_SIZE);
+    const uint64_t hash = Hash(key);
+    Recent& recent = recent_[RecentSlot(hash)];
+    recent.key = key;
+    recent.data = value;
+    recent.valid = true;
+    if (snapshot_taken_) AppendEntry(unsaved_, key, value);
+    // a key that is already cached (e.g. from an overlapping dump) only
+    // counts one more use and must not evict another entry
+    recent.slot = Locate(key, hash);
+    if (recent.slot < keys_.size()) {
+      uses_[recent.slot] = std::min<int>(uses_[recent.slot] + 1, UINT8_MAX);
+      return;
+    }
+    if (size_ >= MaxLoad(keys_.size())) {
+      if (keys_.size() < max_slots_)
+        Resize(keys_.empty() ? MinSlots() : 2 * keys_.size());
+      else
+        Evict(hash);
+    }
+    recent.slot = Place(key, value, 1);
   }
 
   virtual typename CacheBase<Key, Data>::Match Find(const Key key) /*const*/ {
     typename CacheBase<Key, Data>::Match match;
-    match.matched = false;
     match.first = key;
-    CacheMapIt iter = data_.find(key);
-    if (iter != data_.end()) {
-      match.matched = true;
-      match.first = iter->first;
-      match.second = iter->second.first;
-      lru_data_.splice(lru_data_.begin(), lru_data_, iter->second.second);
-      iter->second.second = lru_data_.begin();
-    }
+    match.matched = Find(key, match.second);
     return match;
   }
 
-  virtual void Clear() { data_.clear(); }
+  virtual bool Find(const Key key, Data& data) {
+    if (keys_.empty()) return false;
+    const uint64_t hash = Hash(key);
+    Recent& recent = recent_[RecentSlot(hash)];
+    if (recent.valid && functions_(recent.key, key)) {
+      data = recent.data;
+      // the entry may have been moved or evicted from the slot since
+      const uint64_t slot = recent.slot;
+      if (slot < keys_.size() && !uses_[slot] && distances_[slot] &&
+          functions_(keys_[slot], key))
+        uses_[slot] = 1;
+      return true;
+    }
+    const uint64_t slot = Locate(key, hash);
+    if (slot == keys_.size()) return false;
+    data = data_[slot];
+    if (!uses_[slot]) uses_[slot] = 1;
+    recent.key = keys_[slot];
+    recent.data = data_[slot];
+    recent.slot = slot;
+    recent.valid = true;
+    return true;
+  }
+
+  virtual void Prefetch(const Key key) const {
+#ifdef __GNUC__
+    if (keys_.empty()) return;
+    const uint64_t slot = Hash(key) & (keys_.size() - 1);
+    __builtin_prefetch(&distances_[slot]);
+    __builtin_prefetch(&keys_[slot]);
+#endif
+  }
+
+  virtual void Clear() {
+    recent_.clear();
+    keys_.clear();
+    data_.clear();
+    distances_.clear();
+    uses_.clear();
+    size_ = 0;
+  }
 
-  virtual int64_t GetSize() { return data_.size(); }
+  virtual int64_t GetSize() { return size_; }
 
   virtual void SetSize(int64_t size) {}
 
@@ -65,9 +144,60 @@ class DynamicCache : public CacheBase<Key, Data> {
 
   virtual bool LoadDump() {
     if (this->filepath == nullptr) return false;
-    FILE* file = fopen(this->filepath, "r");
+    return ReadDump(this->filepath, true);
+  }
+
+  virtual bool MergeDump(const char* filepath) {
+    return ReadDump(filepath, false);
+  }
+
+  virtual bool SaveDump() {
+    if (this->filepath == nullptr) return false;
+    if (size_ <= 0) return true;
+    FILE* file = fopen(this->filepath, "w");
+    if (file == nullptr) return false;
+    for (uint64_t slot = 0; slot < keys_.size(); ++slot) {
+      if (distances_[slot] == 0) continue;
+      const char* kbuf = keys_[slot].GetBytePtr();
+      const char* vbuf = data_[slot].GetBytePtr();
+      if (fwrite(kbuf, keys_[slot].GetByteSize(), 1, file) != 1 ||
+          fwrite(vbuf, data_[slot].GetByteSize(), 1, file) != 1) {
+        fclose(file);
+        std::cerr << "writing cache dump file " << this->filepath << " failed"
+                  << std::endl;
+        return false;
+      }
+    }
+    std::cout << "writing cache dump file " << this->filepath
+              << " was successful" << std::endl;
+    fclose(file);
+    return true;
+  }
+
+  virtual bool TakeSnapshot(CacheSnapshot& snapshot, bool full) {
+    if (this->filepath == nullptr) return false;
+    snapshot.filepath = this->filepath;
+    snapshot.append = snapshot_taken_ && !full;
+    snapshot.bytes.clear();
+    if (snapshot.append) {
+      snapshot.bytes.swap(unsaved_);
+    } else {
+      unsaved_.clear();
+      for (uint64_t slot = 0; slot < keys_.size(); ++slot)
+        if (distances_[slot])
+          AppendEntry(snapshot.bytes, keys_[slot], data_[slot]);
+    }
+    snapshot_taken_ = true;
+    return !snapshot.bytes.empty();
+  }
+
+ private:
+  // inserts the entries of a dump file, keys that are already cached count
+  // one more use
+  bool ReadDump(const char* filepath, bool clear) {
+    FILE* file = fopen(filepath, "r");
     if (file == nullptr) {
-      // std::cout << "cache dump file " << this->filepath << " not found" <<
+      // std::cout << "cache dump file " << filepath << " not found" <<
       // std::endl;
       return false;
     }
@@ -77,64 +207,173 @@ class DynamicCache : public CacheBase<Key, Data> {
     int vsiz = data.GetByteSize();
     char* kbuf = new char[ksiz];
     char* vbuf = new char[vsiz];
-    data_.clear();
+    if (clear) Clear();
     while (fread(kbuf, ksiz, 1, file) == 1 && fread(vbuf, vsiz, 1, file) == 1) {
       key.SetFromBytePtr(kbuf, ksiz);
       data.SetFromBytePtr(vbuf, vsiz);
       Insert(key, data);
     }
-    std::cout << "reading cache dump file " << this->filepath
-              << " was successful, new cache size: " << data_.size()
-              << std::endl;
+    std::cout << "reading cache dump file " << filepath
+              << " was successful, new cache size: " << size_ << std::endl;
     delete[] kbuf;
     delete[] vbuf;
     fclose(file);
     return true;
   }
 
-  virtual bool SaveDump() {
-    if (this->filepath == nullptr) return false;
-    if (data_.size() <= 0) return true;
-    FILE* file = fopen(this->filepath, "w");
-    if (file == nullptr) return false;
-    CacheMapIt it = data_.begin();
-    int ksiz = it->first.GetByteSize();
-    int vsiz = it->second.first.GetByteSize();
-    for (; it != data_.end(); ++it) {
-      const char* kbuf = it->first.GetBytePtr();
-      const char* vbuf = it->second.first.GetBytePtr();
-      if (fwrite(kbuf, ksiz, 1, file) != 1 ||
-          fwrite(vbuf, vsiz, 1, file) != 1) {
-        fclose(file);
-        std::cerr << "writing cache dump file " << this->filepath << " failed"
-                  << std::endl;
-        return false;
+  static void AppendEntry(std::string& bytes, const Key& key,
+                          const Data& data) {
+    bytes.append(key.GetBytePtr(), key.GetByteSize());
+    bytes.append(data.GetBytePtr(), data.GetByteSize());
+  }
+
+  // the upper bits of the hash, the large table uses the lower ones
+  static uint64_t RecentSlot(uint64_t hash) {
+    return hash >> (64 - RECENT_CACHE_SIZE);
+  }
+
+  uint64_t MinSlots() const { return max_slots_ < 1024 ? max_slots_ : 1024; }
+
+  static uint64_t MaxLoad(uint64_t slots) { return slots - slots / 8; }
+
+  uint64_t Hash(const Key& key) const {
+    // the key hash is close to the identity of the packed conditions, so mix
+    // all bits into the lower ones used for the slot (splitmix64 finalizer)
+    uint64_t h = functions_(key);
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ull;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebull;
+    return h ^ (h >> 31);
+  }
+
+  // returns the slot of the key in the large table, or the number of slots if
+  // it is not cached
+  uint64_t Locate(const Key& key, uint64_t hash) const {
+    if (keys_.empty()) return 0;
+    const uint64_t mask = keys_.size() - 1;
+    uint64_t slot = hash & mask;
+    for (int dist = 1; distances_[slot] >= dist; dist++) {
+      if (distances_[slot] == dist && functions_(keys_[slot], key)) return slot;
+      slot = (slot + 1) & mask;
+    }
+    return keys_.size();
+  }
+
+  // inserts the entry or, if the key is already cached, adds the uses to its
+  // count; if the probe distance would overflow, the entry displaced last is
+  // dropped instead; returns the slot of the key, or the number of slots if
+  // it was dropped itself
+  uint64_t Place(Key key, Data value, uint8_t uses) {
+    const uint64_t mask = keys_.size() - 1;
+    uint64_t slot = Hash(key) & mask;
+    uint64_t placed = keys_.size();
+    for (int dist = 1; dist <= UINT8_MAX; dist++) {
+      if (distances_[slot] == 0) {
+        keys_[slot] = std::move(key);
+        data_[slot] = std::move(value);
+        distances_[slot] = dist;
+        uses_[slot] = uses;
+        size_++;
+        return placed == keys_.size() ? slot : placed;
+      }
+      if (distances_[slot] == dist && functions_(keys_[slot], key)) {
+        uses_[slot] = std::min<int>(uses_[slot] + uses, UINT8_MAX);
+        return slot;
       }
+      if (distances_[slot] < dist) {
+        if (placed == keys_.size()) placed = slot;
+        std::swap(keys_[slot], key);
+        std::swap(data_[slot], value);
+        std::swap(uses_[slot], uses);
+        const int displaced = distances_[slot];
+        distances_[slot] = dist;
+        dist = displaced;
+      }
+      slot = (slot + 1) & mask;
     }
-    std::cout << "writing cache dump file " << this->filepath
-              << " was successful" << std::endl;
-    fclose(file);
-    return true;
+#ifdef CACHE_STATISTICS
+    this->statistics_.evictions++;
+#endif
+    return placed;
   }
 
- private:
-  void Evict() {
-    assert(!lru_data_.empty());
-    CacheMapIt it = data_.find(lru_data_.back());
-    assert(it != data_.end());
-    data_.erase(it);
-    lru_data_.pop_back();
+  // removes the entry by shifting the following entries of the cluster back
+  void Erase(uint64_t slot) {
+    const uint64_t mask = keys_.size() - 1;
+    uint64_t next = (slot + 1) & mask;
+    while (distances_[next] > 1) {
+      keys_[slot] = std::move(keys_[next]);
+      data_[slot] = std::move(data_[next]);
+      distances_[slot] = distances_[next] - 1;
+      uses_[slot] = uses_[next];
+      slot = next;
+      next = (next + 1) & mask;
+    }
+    data_[slot] = Data();
+    distances_[slot] = 0;
+    size_--;
   }
 
-  typedef typename std::list<Key>::iterator ListIt;
+  void Resize(uint64_t slots) {
+    HugePageVector<Key> keys(slots);
+    HugePageVector<Data> data(slots);
+    HugePageVector<uint8_t> distances(slots, 0);
+    HugePageVector<uint8_t> uses(slots, 0);
+    keys_.swap(keys);
+    data_.swap(data);
+    distances_.swap(distances);
+    uses_.swap(uses);
+    size_ = 0;
+    for (uint64_t slot = 0; slot < keys.size(); ++slot)
+      if (distances[slot])
+        Place(std::move(keys[slot]), std::move(data[slot]), uses[slot]);
+  }
 
-  typedef std::unordered_map<Key, std::pair<Data, ListIt>, Key, Key> CacheMap;
-  typedef typename std::unordered_map<Key, std::pair<Data, ListIt>, Key,
-                                      Key>::iterator CacheMapIt;
+  // evicts the least used of the first entries from the home slot of the new
+  // key and ages the others; a clock hand sweeping the table would empty the
+  // slots behind it and leave long clusters of probes in front of it
+  void Evict(uint64_t hash) {
+    assert(size_ > 0);
+    const uint64_t mask = keys_.size() - 1;
+    uint64_t slot = hash & mask;
+    uint64_t victim = slot;
+    for (int candidates = 0; candidates < kEvictionCandidates;
+         slot = (slot + 1) & mask) {
+      if (distances_[slot] == 0) continue;
+      if (candidates++ == 0 || uses_[slot] < uses_[victim]) victim = slot;
+      if (uses_[slot]) uses_[slot]--;
+    }
+    Erase(victim);
+#ifdef CACHE_STATISTICS
+    this->statistics_.evictions++;
+#endif
+  }
+
+  // number of entries compared by Evict
+  static constexpr int kEvictionCandidates = 8;
+
+  struct Recent {
+    Key key;
+    Data data;
+    // slot of the entry in the large table when it was stored here
+    uint64_t slot = 0;
+    bool valid = false;
+  };
 
-  CacheMap data_;
-  uint64_t capacity_;
-  std::list<Key> lru_data_;
+  // recently used entries, allocated with the first insertion
+  HugePageVector<Recent> recent_;
+  HugePageVector<Key> keys_;
+  HugePageVector<Data> data_;
+  // probe distance + 1 of the entry in each slot, 0 for empty slots
+  HugePageVector<uint8_t> distances_;
+  // CLOCK use counts, at least 1 after a hit and counting the merged dumps
+  HugePageVector<uint8_t> uses_;
+  uint64_t max_slots_;
+  uint64_t size_ = 0;
+  // entries inserted since the last snapshot, in the format of the dump file
+  std::string unsaved_;
+  bool snapshot_taken_ = false;
+  // hash and equality functions of the keys
+  Key functions_;
 };
 
 #endif  // DYNAMIC_CACHE_H_
@@ -0,0 +1,98 @@
+#ifndef HUGE_PAGE_ALLOCATOR_H_
+#define HUGE_PAGE_ALLOCATOR_H_
+
+// size of a huge page in bytes, smaller allocations use the default pages;
+// 0 disables huge pages
+#ifndef HUGE_PAGE_SIZE
+#define HUGE_PAGE_SIZE (1 << 21)
+#endif
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#if defined(__linux__) && HUGE_PAGE_SIZE > 0
+#define USE_HUGE_PAGES
+#include <sys/mman.h>
+#endif
+
+/*!
+ * \brief Allocator for the large tables of the caches, backed by huge pages
+ * where possible.
+ *
+ * The probes of the caches are random accesses into tables of up to several
+ * hundred MB, so with the default pages almost every probe is a TLB miss.
+ * Allocations of at least HUGE_PAGE_SIZE bytes are mapped with explicit huge
+ * pages if some are reserved (MAP_HUGETLB), otherwise the mapping is advised to
+ * be backed by transparent huge pages (MADV_HUGEPAGE). Without huge page
+ * support, this falls back to the default pages.
+ */
+template <class T>
+class HugePageAllocator {
+ public:
+  typedef T value_type;
+
+  HugePageAllocator() {}
+
+  template <class U>
+  HugePageAllocator(const HugePageAllocator<U>&) {}
+
+  T* allocate(std::size_t n) {
+    const std::size_t bytes = n * sizeof(T);
+#ifdef USE_HUGE_PAGES
+    if (bytes >= HUGE_PAGE_SIZE) {
+      const std::size_t size = RoundUp(bytes);
+      void* p = MAP_FAILED;
+#ifdef MAP_HUGETLB
+      p = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+      if (p == MAP_FAILED) {
+        p = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+        // only a hint, ignored if transparent huge pages are disabled
+        madvise(p, size, MADV_HUGEPAGE);
+#endif
+      }
+      return static_cast<T*>(p);
+    }
+#endif
+    return static_cast<T*>(::operator new(bytes));
+  }
+
+  void deallocate(T* p, std::size_t n) {
+#ifdef USE_HUGE_PAGES
+    if (n * sizeof(T) >= HUGE_PAGE_SIZE) {
+      munmap(p, RoundUp(n * sizeof(T)));
+      return;
+    }
+#endif
+    ::operator delete(p);
+  }
+
+ private:
+#ifdef USE_HUGE_PAGES
+  // whole huge pages, so that MAP_HUGETLB mappings can be unmapped
+  static std::size_t RoundUp(std::size_t bytes) {
+    return (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+  }
+#endif
+};
+
+template <class T, class U>
+bool operator==(const HugePageAllocator<T>&, const HugePageAllocator<U>&) {
+  return true;
+}
+
+template <class T, class U>
+bool operator!=(const HugePageAllocator<T>&, const HugePageAllocator<U>&) {
+  return false;
+}
+
+template <class T>
+using HugePageVector = std::vector<T, HugePageAllocator<T>>;
+
+#endif  // HUGE_PAGE_ALLOCATOR_H_
@@ -29,6 +29,7 @@ class KonstantConditionProxy : public LinkableConditionProxy {
                              Condition<3> condition, int start = 0) const;
   virtual int IsPosKonstant(int pos) const;
   virtual std::string ToString() const;
+  uint64_t GetKonstant() const { return condition_; }
 
  protected:
   const uint64_t condition_;
@@ -57,6 +57,8 @@ class LinearStep : public Step {
 
   virtual std::string GetName() const { return std::string("LinearStep"); }
 
+  virtual bool IsLinearStep() const { return true; }
+
   virtual StepData* CreateStepData() const {
     assert(F::kNumInputs + F::kNumOutputs == params_.size());
     LinearStepData* data =
@@ -187,10 +189,9 @@ class LinearStep : public Step {
     return probability;
   }
 
-  virtual std::vector<TwobitCondition> UpdateTwobitCondition(
-      Characteristic& characteristic, Bitpos pos) const {
-    return std::vector<TwobitCondition>();
-  }
+  virtual void UpdateTwobitCondition(
+      Characteristic& characteristic, Bitpos pos,
+      std::vector<TwobitCondition>& twobit) const {}
 };
 
 #endif  // LINEAR_STEP_H_
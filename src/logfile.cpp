@@ -0,0 +1,91 @@
+#include "logfile.h"
+
+namespace {
+
+// the open logfiles, for FlushAll
+std::mutex& OpenLogfilesMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+std::set<Logfile*>& OpenLogfiles() {
+  static std::set<Logfile*> logfiles;
+  return logfiles;
+}
+
+}  // namespace
+
+Logfile::Logfile() : Logfile("") {}
+
+Logfile::Logfile(std::string file_name)
+    : file_name_(file_name), queue_size_(0), stop_(false) {
+  if (file_name_.compare(""))
+    file_stream_.open(file_name_.c_str(), std::ios::out | std::ios::app);
+  writer_ = std::thread(&Logfile::WriterLoop, this);
+  std::lock_guard<std::mutex> lock(OpenLogfilesMutex());
+  OpenLogfiles().insert(this);
+}
+
+Logfile::~Logfile() {
+  {
+    std::lock_guard<std::mutex> lock(OpenLogfilesMutex());
+    OpenLogfiles().erase(this);
+  }
+  Flush();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  queue_changed_.notify_all();
+  writer_.join();
+  if (file_name_.compare("")) file_stream_.close();
+}
+
+void Logfile::Submit() {
+  std::string chunk = buffer_.str();
+  if (chunk.empty()) return;
+  buffer_.str("");
+  std::unique_lock<std::mutex> lock(mutex_);
+  // bound the memory by blocking until the writer catches up; a single chunk
+  // larger than the limit is still accepted once the queue is empty
+  queue_changed_.wait(lock, [this, &chunk] {
+    return queue_size_ == 0 ||
+           queue_size_ + chunk.size() <= MAX_LOGFILE_QUEUE_SIZE;
+  });
+  queue_size_ += chunk.size();
+  queue_.push_back(std::move(chunk));
+  queue_changed_.notify_all();
+}
+
+void Logfile::Flush() {
+  Submit();
+  std::unique_lock<std::mutex> lock(mutex_);
+  queue_changed_.wait(lock, [this] { return queue_size_ == 0; });
+}
+
+void Logfile::FlushAll() {
+  std::lock_guard<std::mutex> lock(OpenLogfilesMutex());
+  for (Logfile* logfile : OpenLogfiles()) logfile->Flush();
+}
+
+void Logfile::WriterLoop() {
+  std::ostream& os = file_name_.compare("") ? file_stream_ : std::cout;
+  std::deque<std::string> chunks;
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    queue_changed_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+    if (queue_.empty()) break;
+    chunks.swap(queue_);
+    lock.unlock();
+    size_t written = 0;
+    for (const std::string& chunk : chunks) {
+      os.write(chunk.data(), chunk.size());
+      written += chunk.size();
+    }
+    os.flush();
+    chunks.clear();
+    lock.lock();
+    queue_size_ -= written;
+    queue_changed_.notify_all();
+  }
+}
@@ -1,39 +1,42 @@
 #ifndef LOGFILE_H_
 #define LOGFILE_H_
 
+#include <condition_variable>
+#include <deque>
 #include <fstream>
 #include <iostream>
+#include <mutex>
+#include <set>
+#include <sstream>
 #include <string>
+#include <thread>
+
+// maximal number of bytes waiting for the writer thread before the caller
+// blocks
+#define MAX_LOGFILE_QUEUE_SIZE (16 << 20)
 
 /*!
  * \brief A wrapper around a stream providing several helper functions.
+ *
+ * Output is formatted into a local buffer which is handed to a background
+ * writer thread on every std::endl or std::flush, so slow terminals or disks
+ * do not stall the caller. Use Flush() before writing to stdout directly and
+ * FlushAll() before calling exit(), which skips the destructors; the
+ * destructor flushes as well.
  */
 class Logfile {
  public:
-  Logfile() : file_name_("") {}
-
-  Logfile(std::string file_name) : file_name_(file_name) {
-    if (file_name_.compare(""))
-      file_stream_.open(file_name_.c_str(), std::ios::out | std::ios::app);
-  }
+  Logfile();
+  Logfile(std::string file_name);
+  virtual ~Logfile();
+  Logfile(const Logfile&) = delete;
+  Logfile& operator=(const Logfile&) = delete;
 
-  virtual ~Logfile() {
-    if (file_name_.compare("")) file_stream_.close();
-  }
-
-  std::ostream& getStream() {
-    if (file_name_.compare(""))
-      return file_stream_;
-    else
-      return std::cout;
-  }
+  std::ostream& getStream() { return buffer_; }
 
   template <typename T>
   Logfile& operator<<(const T& s) {
-    if (file_name_.compare(""))
-      file_stream_ << s;
-    else
-      std::cout << s;
+    buffer_ << s;
     return *this;
   }
 
@@ -54,18 +57,35 @@ class Logfile {
   // this is the function signature of std::endl
   typedef CoutType& (*StandardEndLine)(CoutType&);
 
-  // define an operator<< to take in std::endl
+  // define an operator<< to take in std::endl (and std::flush)
   Logfile& operator<<(StandardEndLine manip) {
-    if (file_name_ == "")
-      manip(std::cout);
-    else
-      manip(file_stream_);
+    manip(buffer_);
+    Submit();
     return *this;
   }
 
+  // hand the buffered output to the writer thread
+  void Submit();
+
+  // submit and wait until everything has been written
+  void Flush();
+
+  // flush all open logfiles (before exit() in error paths)
+  static void FlushAll();
+
  private:
+  void WriterLoop();
+
   std::string file_name_;
   std::fstream file_stream_;
+  std::ostringstream buffer_;
+
+  std::deque<std::string> queue_;
+  size_t queue_size_;
+  bool stop_;
+  std::mutex mutex_;
+  std::condition_variable queue_changed_;
+  std::thread writer_;
 };
 
 #endif  // LOGFILE_H_
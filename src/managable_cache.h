@@ -1,6 +1,36 @@
 #ifndef MANAGABLE_CACHE_H_
 #define MANAGABLE_CACHE_H_
 
+#include <cstdint>
+#include <string>
+
+// collect hit/miss/eviction/contradiction counters and the time spent on
+// misses per cache
+//#define CACHE_STATISTICS
+
+/*!
+ * \brief Usage counters of a single cache, only updated if CACHE_STATISTICS is
+ * defined.
+ */
+struct CacheStatistics {
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t evictions = 0;
+  // lookups of the propagation that resulted in a contradiction
+  uint64_t contradictions = 0;
+  double miss_seconds = 0;
+};
+
+/*!
+ * \brief Serialized entries of a cache that are written to its dump file.
+ */
+struct CacheSnapshot {
+  std::string filepath;
+  std::string bytes;
+  // the bytes are appended to the dump file, otherwise they replace it
+  bool append = false;
+};
+
 /*!
  * \brief The abstract base class, allowing to load and save cache dumps.
  */
@@ -11,9 +41,29 @@ class ManagableCache {
   virtual ~ManagableCache();
   virtual bool LoadDump() = 0;
   virtual bool SaveDump() = 0;
+  // inserts the entries of the dump file of another run; caches that are
+  // computed completely at the start have nothing to merge
+  virtual bool MergeDump(const char* filepath) { return true; }
+  // serializes all entries or, after the first snapshot, only the entries
+  // added since the last one; returns false if there is nothing to write
+  virtual bool TakeSnapshot(CacheSnapshot& snapshot, bool full) {
+    return false;
+  }
+  virtual int64_t GetSize() = 0;
+
+  void SetName(const std::string& name) { name_ = name; }
+  const std::string& GetName() const { return name_; }
+  // the dump file, set once the cache is used
+  const char* GetDumpFilepath() const { return filepath; }
+
+  CacheStatistics& GetStatistics() { return statistics_; }
 
  protected:
   char* filepath;
+  CacheStatistics statistics_;
+
+ private:
+  std::string name_;
 };
 
 #endif  // MANAGABLE_CACHE_H_
@@ -10,6 +10,7 @@
 
 #include "bitslice_data.h"
 #include "probability_output_matrix.h"
+#include "probability_output_sparse_matrix.h"
 #include "utils.h"
 
 /*!
@@ -20,11 +21,11 @@ template <class F>
 class ProbabilityMatrix {
  public:
   typedef BitsliceData<F> Input;
-  typedef ProbabilityOutputMatrix Output;
+  typedef ProbabilityOutputSparseMatrix<F::kStateSize> Output;
 
   void Initialize(Input input) {
     input_ = input;
-    output_ = Output(F::kStateSize);
+    output_ = ProbabilityOutputMatrix(F::kStateSize);
   }
 
   void Collect(BitslicePair<F> val) {
@@ -51,14 +52,14 @@ class ProbabilityMatrix {
       }
       total_possibilities *= possibilities;
     }
-    output_.Divide((float)total_possibilities);
-    return output_;
+    return Output(output_, (float)total_possibilities);
   }
 
   static std::string GetName() { return "ProbabilityMatrix"; }
 
   Input input_;
-  Output output_;
+  // number of pairs for each state transition
+  ProbabilityOutputMatrix output_;
   unsigned int state_reordering_[3][64] = {
       {0, 1, 2, 3},
       {0, 1, 4, 9, 2, 3, 6, 11, 5, 7, 8, 13, 10, 12, 14, 15},
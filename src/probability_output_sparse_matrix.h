@@ -0,0 +1,104 @@
+#ifndef PROBABILITY_OUTPUT_SPARSE_MATRIX_H_
+#define PROBABILITY_OUTPUT_SPARSE_MATRIX_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "probability_output_matrix.h"
+
+/*!
+ * \brief Compact output of the \see ProbabilityMatrix action, as stored in the
+ * caches.
+ *
+ * Most state transitions of a bitslice are impossible, so only the non-zero
+ * entries are kept, sorted by row, as number of pairs together with the
+ * common divisor. The dense \see ProbabilityOutputMatrix with kStateSize rows
+ * and columns is expanded when it is needed for the multiplication.
+ *
+ * The records of the cache dumps have a fixed size, so an entry is dumped as
+ * the number of entries and the divisor, followed by the entries padded to
+ * the maximum of kStateSize^2.
+ */
+template <int kStateSize>
+class ProbabilityOutputSparseMatrix {
+ public:
+  static_assert(kStateSize * kStateSize <= UINT16_MAX + 1,
+                "the index of an entry has to fit 16 bits");
+
+  struct Entry {
+    uint16_t index;  // row * kStateSize + column
+    uint32_t count;
+  };
+
+  std::vector<Entry> entries_;
+  float divisor_;
+
+  ProbabilityOutputSparseMatrix() : entries_(), divisor_(0) {}
+
+  ProbabilityOutputSparseMatrix(const ProbabilityOutputMatrix& counts,
+                                float divisor)
+      : entries_(), divisor_(divisor) {
+    assert(counts.size_ == kStateSize);
+    for (int i = 0; i < counts.matrix_.size(); ++i)
+      if (counts.matrix_[i] != 0)
+        entries_.push_back(Entry{uint16_t(i), uint32_t(counts.matrix_[i])});
+    entries_.shrink_to_fit();
+  }
+
+  ProbabilityOutputMatrix Expand() const {
+    ProbabilityOutputMatrix result(kStateSize);
+    if (divisor_ == 0) return result;
+    for (const Entry& entry : entries_)
+      result.matrix_[entry.index] = float(entry.count) / divisor_;
+    return result;
+  }
+
+  int GetRows() const { return kStateSize; }
+  int GetColums() const { return kStateSize; }
+
+  friend std::ostream& operator<<(std::ostream& os,
+                                  const ProbabilityOutputSparseMatrix& t) {
+    return os << t.Expand();
+  }
+
+  void ResortOutput(uint8_t perm[], int len) {}
+
+  // the record is serialized into a buffer shared by all matrices of this
+  // size, so the pointer is valid until the next call
+  const char* GetBytePtr() const {
+    static Record record;
+    memset(&record, 0, sizeof(record));
+    record.num_entries = entries_.size();
+    record.divisor = divisor_;
+    std::copy(entries_.begin(), entries_.end(), record.entries);
+    return reinterpret_cast<const char*>(&record);
+  }
+
+  int GetByteSize() const { return sizeof(Record); }
+
+  void SetFromBytePtr(const char* data, int size) {
+    assert(size == sizeof(Record));
+    uint32_t num_entries;
+    memcpy(&num_entries, data + offsetof(Record, num_entries),
+           sizeof(num_entries));
+    assert(num_entries <= kStateSize * kStateSize);
+    memcpy(&divisor_, data + offsetof(Record, divisor), sizeof(divisor_));
+    entries_.resize(num_entries);
+    memcpy(entries_.data(), data + offsetof(Record, entries),
+           num_entries * sizeof(Entry));
+  }
+
+ private:
+  struct Record {
+    uint32_t num_entries;
+    float divisor;
+    Entry entries[kStateSize * kStateSize];
+  };
+};
+
+#endif  // PROBABILITY_OUTPUT_SPARSE_MATRIX_H_
@@ -1,6 +1,6 @@
 #include "propagate_twobit_output.h"
 
-std::ostream& operator<<(std::ostream& os, PropagateTwobitOutput& t) {
+std::ostream& operator<<(std::ostream& os, const PropagateTwobitOutput& t) {
   for (int i = 0; i < t.twobit_list_.size(); i++) {
     os << t.twobit_list_[i];
     if (i != t.twobit_list_.size() - 1) os << ",";
@@ -9,12 +9,11 @@ std::ostream& operator<<(std::ostream& os, PropagateTwobitOutput& t) {
 }
 
 void PropagateTwobitOutput::ResortOutput(uint8_t perm[], int len) {
-  std::vector<BitsliceTwobitCondition> old_list(twobit_list_);
   for (int i = 0; i < twobit_list_.size(); i++) {
     assert(twobit_list_[i].c == 1 || twobit_list_[i].c == 2 ||
            twobit_list_[i].c == 4 || twobit_list_[i].c == 8);
-    twobit_list_[i].a = perm[old_list[i].a];
-    twobit_list_[i].b = perm[old_list[i].b];
+    twobit_list_[i].a = perm[twobit_list_[i].a];
+    twobit_list_[i].b = perm[twobit_list_[i].b];
   }
 }
 
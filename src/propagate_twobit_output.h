@@ -13,7 +13,8 @@
 class PropagateTwobitOutput {
  public:
   std::vector<BitsliceTwobitCondition> twobit_list_;
-  friend std::ostream& operator<<(std::ostream& os, PropagateTwobitOutput& t);
+  friend std::ostream& operator<<(std::ostream& os,
+                                  const PropagateTwobitOutput& t);
   void ResortOutput(uint8_t perm[], int len);
   const char* GetBytePtr() const;
   int GetByteSize() const;
@@ -0,0 +1,102 @@
+#ifndef SBOX_TABLE_H_
+#define SBOX_TABLE_H_
+
+#include <cstdint>
+
+#include "bitslice_data.h"
+#include "functions.h"
+#include "utils.h"
+
+/*!
+ * \brief Propagation of a bitslice function with precomputed sets of pairs
+ * instead of enumerating all pairs.
+ *
+ * The default does not know the function, so \see Bitslice uses the cache and
+ * the \see Loop for it.
+ */
+template <class F>
+class SboxTable {
+ public:
+  static const bool kEnabled = false;
+
+  static BitsliceData<F> Propagate(const BitsliceData<F>& input) {
+    return input;
+  }
+};
+
+/*!
+ * \brief Precomputed sets of input pairs of an S-box for all conditions.
+ *
+ * An input pair (x, x') of the S-box is the bit x | x' << I of a bitset. For
+ * every input and output bit and every condition on it, the table holds the
+ * set of input pairs that fulfill the condition. For the outputs, these are
+ * the rows of the differential distribution table split by values. The input
+ * pairs allowed by all conditions are the intersection of their sets. The
+ * new conditions are the union of the conditions of the allowed pairs, which
+ * are also precomputed. This gives exactly the result of \see Propagate in
+ * the \see Loop (checked by nldpropcheck), without evaluating the S-box and
+ * without a cache.
+ *
+ * The table has (I + O) * 16 sets of 4^I bits, 28 KB in total for a 5-bit
+ * S-box, so it is only used for up to 5 inputs.
+ */
+template <int I, int O, const uint8_t LUT[]>
+class SboxTable<SBOX<I, O, LUT>> {
+ public:
+  static const bool kEnabled = I <= 5;
+
+  static BitsliceData<SBOX<I, O, LUT>> Propagate(
+      const BitsliceData<SBOX<I, O, LUT>>& input) {
+    static const Table table;
+    uint64_t allowed[kNumWords];
+    for (int w = 0; w < kNumWords; w++) allowed[w] = kPairMask;
+    for (int c = 0; c < I + O; c++) {
+      const uint64_t* set = table.sets[c][input.GetCondition(c)];
+      for (int w = 0; w < kNumWords; w++) allowed[w] &= set[w];
+    }
+
+    // the conditions of all allowed pairs, four bits per input and output
+    uint64_t kept = 0;
+    for (int w = 0; w < kNumWords; w++)
+      for (uint64_t pairs = allowed[w]; pairs; pairs &= pairs - 1)
+        kept |=
+            table.conditions[w * 64 + nldtool::CountTrailingZeros(pairs)];
+    BitsliceData<SBOX<I, O, LUT>> output;
+    for (int c = 0; c < I + O; c++)
+      output.SetCondition(c, (kept >> 4 * c) & 15);
+    return output;
+  }
+
+ private:
+  static const int kNumPairs = 1 << (2 * I);
+  static const int kNumWords = (kNumPairs + 63) / 64;
+  static_assert(I + O <= 16, "the conditions have to fit into 64 bits");
+  static const uint64_t kPairMask =
+      kNumPairs >= 64 ? ~0ull : (1ull << (kNumPairs % 64)) - 1;
+
+  struct Table {
+    // sets[c][cond] for the condition cond on input or output bit c
+    uint64_t sets[I + O][16][kNumWords];
+    // conditions[pair] has the bit of the pair in each condition set
+    uint64_t conditions[kNumPairs];
+
+    Table() : sets(), conditions() {
+      for (int pair = 0; pair < kNumPairs; pair++) {
+        const int x[2] = {pair & ((1 << I) - 1), pair >> I};
+        const int y[2] = {LUT[x[0]], LUT[x[1]]};
+        for (int c = 0; c < I + O; c++) {
+          // the bit order of SBOX::f, the first bit is the most significant
+          const int bit = c < I ? I - 1 - c : O - 1 - (c - I);
+          const int* v = c < I ? x : y;
+          const int p = ((v[1] >> bit) & 1) << 1 | ((v[0] >> bit) & 1);
+          conditions[pair] |= 1ull << (4 * c + p);
+          for (int cond = 0; cond < 16; cond++)
+            if ((cond >> p) & 1)
+              sets[c][cond][pair / 64] |= 1ull << (pair % 64);
+        }
+      }
+    }
+  };
+};
+
+#endif  // SBOX_TABLE_H_
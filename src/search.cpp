@@ -3,9 +3,10 @@
 #include <algorithm>
 #include <cassert>
 #include <fstream>
-#include <functional>
 #include <iomanip>
 #include <iostream>
+#include <limits>
+#include <numeric>
 
 #include "cache.h"
 #include "cache_manager.h"
@@ -32,6 +33,9 @@ Search::Search(XmlConfig& config, Characteristic& characteristic,
           [](BitCondition bc) {
             return ((bc & -bc) ^ bc) && (bc ^ BitCondition("-"));
           })),
+      free_bits_mask_(initial_free_bits_mask_),
+      twobit_mask_(characteristic_.GetCrypto()->GetWordSize()),
+      twobit_word_mask_(characteristic_.GetCrypto()->GetWordSize()),
       search_stack_(stack_fullstate_frequency),
       logfile_(logfile),
       seed_(seed) {
@@ -44,17 +48,32 @@ Search::Search(XmlConfig& config, Characteristic& characteristic,
   rng_.seed(static_cast<unsigned long>(seed_));
   current_status_.seed = seed_;
   seed_time_ = print_time_ = print_characteristic_time_ = time(0);
+  snapshot_interval_ = 0;
+  snapshot_time_ = time(0);
   seed_ = static_cast<uint32_t>(rng_());
   current_status_.restarts = 0;
   current_status_.found = 0;
   current_status_.absminfree = initial_free_bits_mask_.GetNumBitsSet();
+  current_status_.global_contradictions = 0;
+  current_status_.guesses = 0;
+  current_status_.first_found_time = -1;
+  current_status_.phase_time.resize(config_.GetSearchConfig().phases.size(),
+                                    0);
   current_status_.Init();
+  critical_bits_.reserve(kCriticalBitsLimit + 1);
+  if (!config_.GetSearchConfig().metrics_file.empty())
+    metrics_.reset(new Logfile(config_.GetSearchConfig().metrics_file));
 }
 
 Search::~Search() {}
 
 void Search::PrintInfo(bool print_characteristic) {
   logfile_ << current_status_ << std::endl;
+#ifdef CACHE_STATISTICS
+  CacheManager::PrintStatistics(logfile_.getStream());
+  logfile_ << std::flush;
+#endif
+  if (metrics_) WriteMetrics();
   if (print_characteristic) {
     characteristic_.GenerateTwobitConditions();
     characteristic_.GetTwobitConditions().ComputeTwobitDegrees();
@@ -67,6 +86,17 @@ void Search::PrintInfo(bool print_characteristic) {
   }
 }
 
+void Search::WriteMetrics() {
+  std::ostream& os = metrics_->getStream();
+  os << "{";
+  current_status_.WriteJsonFields(os);
+#ifdef CACHE_STATISTICS
+  os << ",\"caches\":";
+  CacheManager::WriteStatisticsJson(os);
+#endif
+  *metrics_ << "}" << std::endl;
+}
+
 void Search::SetDumpTime(int dump_time) {
   current_status_.dump_time =
       dump_time * 3600;  // conversion from hours to seconds
@@ -76,13 +106,24 @@ void Search::SetDumpCount(int dump_count) {
   current_status_.dump_count = dump_count;
 }
 
+void Search::SetSnapshotInterval(int snapshot_interval) {
+  snapshot_interval_ =
+      snapshot_interval * 60;  // conversion from minutes to seconds
+}
+
 void Search::CheckforDump() {
+  if (snapshot_interval_ > 0 &&
+      time(0) - snapshot_time_ >= snapshot_interval_) {
+    snapshot_time_ = time(0);
+    CacheManager::SnapshotAllCaches();
+  }
   if (current_status_.dump_time <= 0 && current_status_.dump_count <= 0)
     return;  // not active
   if ((current_status_.dump_time > 0 &&
        time(0) - current_status_.start_time >= current_status_.dump_time) ||
       (current_status_.dump_count > 0 &&
        current_status_.restarts >= current_status_.dump_count)) {
+    FlushLogs();
     printf(
         "\ndump condition (time: %d, restarts: %d) has been reached -> start "
         "dumping\n",
@@ -93,6 +134,20 @@ void Search::CheckforDump() {
   }
 }
 
+void Search::FlushLogs() {
+#ifdef CACHE_STATISTICS
+  CacheManager::PrintStatistics(logfile_.getStream());
+#endif
+  logfile_.Flush();
+  if (metrics_) {
+    // the last line always holds the final status
+    WriteMetrics();
+    metrics_->Flush();
+  }
+  // exit() would stop a snapshot in the middle of writing its dump file
+  CacheManager::FlushSnapshots();
+}
+
 void Search::Restart() {
   int current_time = time(0);
   if (config_.GetSearchConfig().print_info != -1 &&
@@ -126,15 +181,15 @@ void Search::Restart() {
   search_stack_.push_back(characteristic_, 0);
 }
 
-Bitmask Search::ComputeTwobitMask(int threshold) {
+const Bitmask& Search::ComputeTwobitMask(int threshold) {
   characteristic_.GenerateTwobitConditions();
   characteristic_.GetTwobitConditions().ComputeTwobitDegrees();
-  Bitmask twobit_mask =
-      characteristic_.GetTwobitConditions().GetTwobitDegreeMask(threshold);
-  return twobit_mask;
+  characteristic_.GetTwobitConditions().GetTwobitDegreeMask(threshold,
+                                                            twobit_mask_);
+  return twobit_mask_;
 }
 
-bool Search::CompleteCheck(Bitmask mask) {
+bool Search::CompleteCheck(const Bitmask& mask) {
   bool result = true;
   std::set<Bitpos> list;
   while (!switched_back_or_stack_empty_ &&
@@ -143,16 +198,20 @@ bool Search::CompleteCheck(Bitmask mask) {
              [](BitCondition bc) {
                return bc == BitCondition("-") || bc == BitCondition("x");
              },
-             mask)) {
+             mask, tmp_characteristic_, free_bits_mask_)) {
     BackTrack();
     guess_critical_bits_ = false;
     result = false;
   }
-  for (auto x : list) AddCriticalBit({GetLastPhase().backtrack_guesses, x});
+  for (auto x : list) AddCriticalBit({&GetLastPhase().backtrack_guesses, x});
   return result;
 }
 
 void Search::UpdateStatus() {
+  const auto now = std::chrono::steady_clock::now();
+  current_status_.phase_time[current_status_.phase] +=
+      std::chrono::duration<double>(now - phase_clock_).count();
+  phase_clock_ = now;
   current_status_.iterations++;
   current_status_.global_iterations++;
   current_status_.stack_size = search_stack_.size();
@@ -165,14 +224,11 @@ void Search::UpdateStatus() {
 }
 
 bool Search::UpdateMinfree() {
-  current_status_.free_bits =
-      characteristic_
-          .GetConditionMask(initial_free_bits_mask_,
-                            [](BitCondition bc) {
-                              return ((bc & -bc) ^ bc) &&
-                                     (bc ^ BitCondition("-"));
-                            })
-          .GetNumBitsSet();
+  free_bits_mask_ = initial_free_bits_mask_;
+  characteristic_.RestrictConditionMask(free_bits_mask_, [](BitCondition bc) {
+    return ((bc & -bc) ^ bc) && (bc ^ BitCondition("-"));
+  });
+  current_status_.free_bits = free_bits_mask_.GetNumBitsSet();
   bool result = current_status_.free_bits < current_status_.absminfree;
   current_status_.minfree =
       std::min(current_status_.minfree, current_status_.free_bits);
@@ -188,41 +244,45 @@ bool Search::IsGuessable(const Config::Setting& setting, BitCondition bc) {
 
 bool Search::GenerateSearchMasks(const std::vector<Config::Setting>& settings) {
   twobit_conditions_generated_ = false;
-  searchmasks_.clear();
-  searchmasks_.reserve(settings.size());
-  for (const Config::Setting& setting : settings)
-    searchmasks_.emplace_back(characteristic_.GetConditionMask(
-        GenerateWordMask(setting),
-        std::bind(IsGuessable, setting, std::placeholders::_1)));
+  // the masks of the previous iteration are overwritten to reuse their storage
+  searchmasks_.resize(settings.size(),
+                      Bitmask(characteristic_.GetCrypto()->GetWordSize()));
+  for (int i = 0; i < settings.size(); ++i) {
+    const Config::Setting& setting = settings[i];
+    GenerateWordMask(setting, searchmasks_[i]);
+    characteristic_.RestrictConditionMask(
+        searchmasks_[i],
+        [&setting](BitCondition bc) { return IsGuessable(setting, bc); });
+  }
   bool result = std::any_of(searchmasks_.begin(), searchmasks_.end(),
                             [](const Bitmask& mask) { return !mask.Empty(); });
   return result;
 }
 
-Bitmask Search::GenerateWordMask(const Config::Setting& setting) {
+void Search::GenerateWordMask(const Config::Setting& setting, Bitmask& mask) {
   int num_words = characteristic_.GetCrypto()->GetNumWords();
-  int word_size = characteristic_.GetCrypto()->GetWordSize();
-  Bitmask mask(word_size);
+  mask.ClearAll();
   if (setting.masks.size() == 0) {
     mask.SetAll(num_words);
   } else {
-    Bitmask tmp(word_size);
     for (int i = 0; i < setting.masks.size(); ++i) {
-      const Config::Mask word = setting.masks[i];
-      tmp = word.bitmask;
+      const Config::Mask& word = setting.masks[i];
       if (word.twobit_threshold > 0) {
         if (twobit_conditions_generated_ == false) {
           characteristic_.GenerateTwobitConditions();
           characteristic_.GetTwobitConditions().ComputeTwobitDegrees();
           twobit_conditions_generated_ = true;
         }
-        tmp &= characteristic_.GetTwobitConditions().GetTwobitDegreeMask(
-            word.twobit_threshold);
+        characteristic_.GetTwobitConditions().GetTwobitDegreeMask(
+            word.twobit_threshold, twobit_mask_);
+        twobit_word_mask_ = word.bitmask;
+        twobit_word_mask_ &= twobit_mask_;
+        mask |= twobit_word_mask_;
+      } else {
+        mask |= word.bitmask;
       }
-      mask |= tmp;
     }
   }
-  return mask;
 }
 
 const Search::Config::Phase& Search::GetCurrentPhase() {
@@ -242,22 +302,36 @@ int Search::ChooseSetting() {
   // distribution that still has bits left to guess, or -1 if none exists
   int num_settings = GetCurrentPhase().settings.size();
   assert(searchmasks_.size() == num_settings);
-  std::vector<int> indices;
-  std::vector<double> weights;
-  indices.reserve(num_settings);
-  weights.reserve(num_settings);
+  std::vector<int>& indices = setting_indices_;
+  std::vector<double>& cumulative = setting_probabilities_;
+  indices.clear();
+  cumulative.clear();
   for (int i = 0; i < num_settings; ++i)
     if (!searchmasks_[i].Empty()) {
       indices.emplace_back(i);
-      weights.emplace_back(GetSetting(i).probability);
+      cumulative.emplace_back(GetSetting(i).probability);
     }
   if (indices.empty()) return -1;
-  std::discrete_distribution<int> distribution(weights.begin(), weights.end());
-  int index = indices[distribution(rng_)];
-  return index;
+  if (indices.size() == 1) return indices[0];
+
+  // samples like std::discrete_distribution of libstdc++ (which does not use
+  // the generator for a single weight), so the random numbers drawn stay the
+  // same, but without allocating the distribution in every iteration; other
+  // standard libraries sample differently, so the search trajectories for a
+  // seed only stay the same as before with libstdc++
+  const double sum = std::accumulate(cumulative.begin(), cumulative.end(), 0.0);
+  for (double& probability : cumulative) probability /= sum;
+  std::partial_sum(cumulative.begin(), cumulative.end(), cumulative.begin());
+  cumulative.back() = 1.0;
+  const double p =
+      std::generate_canonical<double, std::numeric_limits<double>::digits>(
+          rng_);
+  auto pos = std::lower_bound(cumulative.begin(), cumulative.end(), p);
+  return indices[pos - cumulative.begin()];
 }
 
 bool Search::GuessBit(Config::Guess guess, Bitpos pos) {
+  current_status_.guesses++;
   std::uniform_real_distribution<double> real_rand(0.0, 1.0);
   bool pushstack =
       guess.choice_probability > 0.0 && guess.choice_probability < 1.0;
@@ -297,7 +371,7 @@ bool Search::GuessBit(Config::Guess guess, Bitpos pos) {
 
 bool Search::Guess(GuessTask pos) {
   const BitCondition bc = characteristic_.GetBitCondition(pos.pos);
-  const std::vector<Config::Guess>& guesses = pos.guesses;
+  const std::vector<Config::Guess>& guesses = *pos.guesses;
   auto guess = std::find_if(guesses.begin(), guesses.end(),
                             [bc](Config::Guess g) { return g.bc == bc; });
   while (guess != guesses.end()) {
@@ -310,120 +384,138 @@ bool Search::Guess(GuessTask pos) {
 }
 
 void Search::AddCriticalBit(GuessTask bit) {
-  // TODO: back track limit is just hard coded for now
-  static const int btlimit = 10;
-  critical_bits_.push_front(bit);
-  if (critical_bits_.size() > btlimit) critical_bits_.pop_back();
+  critical_bits_.insert(critical_bits_.begin(), bit);
+  if (critical_bits_.size() > kCriticalBitsLimit) critical_bits_.pop_back();
 }
 
 void Search::Start() {
-  int complete_limit = 20;
+  Init();
+  while (1) Iterate();
+}
 
+void Search::Init() {
   current_status_.phase = 0;
   current_status_.start_time = time(0);
+  current_status_.start_clock = std::chrono::steady_clock::now();
   current_status_.global_iterations = 0l;
   credits_ = config_.GetSearchConfig().credits;
+  phase_clock_ = std::chrono::steady_clock::now();
   Restart();
 
   logfile_ << "Info: Search started..." << std::endl;
-  while (1) {
-    //! print info if necessary and check for termination conditions
-    UpdateStatus();
-
-    int current_time = time(0);
-    if (config_.GetSearchConfig().print_info != -1 &&
-        current_time - print_time_ >=
-            config_.GetSearchConfig().print_info * 2) {
-      print_time_ = current_time;
-      PrintInfo();
-    }
-    if (config_.GetSearchConfig().print_characteristic != -1 &&
-        current_time - print_characteristic_time_ >=
-            config_.GetSearchConfig().print_characteristic) {
-      print_characteristic_time_ = current_time;
-      PrintInfo(true);
-    }
-    if (config_.GetSearchConfig().end_time != -1 &&
-        current_time - current_status_.start_time >
-            config_.GetSearchConfig().end_time)
-      exit(1);
-
-    //! handle restart conditions
-    if ((search_stack_.empty() &&
-         credits_ < config_.GetSearchConfig().credits) ||
-        current_status_.remaining_credits <= 0) {
-      Restart();
-      continue;
-    }
+}
 
-    //! if we saved any critical bit positions, guess them first
-    if (guess_critical_bits_) {
-      assert(0 <= critical_bit_index_ &&
-             critical_bit_index_ < critical_bits_.size());
-      GuessTask critical_bit = critical_bits_[critical_bit_index_++];
-      if (!Guess(critical_bit)) BackTrack();
-      if (critical_bit_index_ >= critical_bits_.size())
-        guess_critical_bits_ = false;
-      continue;
-    }
+void Search::Iterate() {
+  const int complete_limit = 20;
 
-    //! choose setting and guess a random bit
-    if (GenerateSearchMasks(GetCurrentPhase().settings)) {
-      GuessTask pos = ChooseGuessPos();
-      if (!Guess(pos)) {
-        AddCriticalBit({GetCurrentPhase().backtrack_guesses, pos.pos});
-        BackTrack();
-      }
-      continue;
-    }
+  //! print info if necessary and check for termination conditions
+  UpdateStatus();
 
-    //! complete check
-    if (GetCurrentPhase().twobit_complete) {
-      int& complete_checks =
-          current_status_.complete_data[current_status_.phase * 2];
-      int& complete_success =
-          current_status_.complete_data[current_status_.phase * 2 + 1];
-      complete_checks++;
-      if (complete_checks > complete_limit * (1 + complete_success)) {
-        Restart();
-        continue;
-      }
-      complete_check_ = true;
-      if (!CompleteCheck(ComputeTwobitMask(2))) {
-        current_status_.remaining_credits--;
-        if (switched_back_or_stack_empty_) complete_check_ = true;
-        continue;
-      }
-      complete_check_ = false;
-      complete_success++;
-    }
+  int current_time = time(0);
+  if (config_.GetSearchConfig().print_info != -1 &&
+      current_time - print_time_ >= config_.GetSearchConfig().print_info * 2) {
+    print_time_ = current_time;
+    PrintInfo();
+  }
+  if (config_.GetSearchConfig().print_characteristic != -1 &&
+      current_time - print_characteristic_time_ >=
+          config_.GetSearchConfig().print_characteristic) {
+    print_characteristic_time_ = current_time;
+    PrintInfo(true);
+  }
+  if (config_.GetSearchConfig().end_time != -1 &&
+      current_time - current_status_.start_time >
+          config_.GetSearchConfig().end_time) {
+    FlushLogs();
+    exit(1);
+  }
+  if (config_.GetSearchConfig().end_iterations != -1 &&
+      current_status_.global_iterations >=
+          config_.GetSearchConfig().end_iterations) {
+    FlushLogs();
+    exit(1);
+  }
 
-    //! crypto specific callback function
-    if (!characteristic_.GetCrypto()->Callback(
-            GetCurrentPhase().callback, characteristic_, rng_, logfile_)) {
-      // Restart();
+  //! handle restart conditions
+  if ((search_stack_.empty() && credits_ < config_.GetSearchConfig().credits) ||
+      current_status_.remaining_credits <= 0) {
+    Restart();
+    return;
+  }
+
+  //! if we saved any critical bit positions, guess them first
+  if (guess_critical_bits_) {
+    assert(0 <= critical_bit_index_ &&
+           critical_bit_index_ < critical_bits_.size());
+    const GuessTask critical_bit = critical_bits_[critical_bit_index_++];
+    if (!Guess(critical_bit)) BackTrack();
+    if (critical_bit_index_ >= critical_bits_.size())
+      guess_critical_bits_ = false;
+    return;
+  }
+
+  //! choose setting and guess a random bit
+  if (GenerateSearchMasks(GetCurrentPhase().settings)) {
+    GuessTask pos = ChooseGuessPos();
+    if (!Guess(pos)) {
+      AddCriticalBit({&GetCurrentPhase().backtrack_guesses, pos.pos});
       BackTrack();
-      // guess_critical_bits_ = false;
-      continue;
     }
+    return;
+  }
 
-    //! if everything is ok, and it is the last phase, we found a characteristic
-    if (config_.IsLastSearchPhase(current_status_.phase)) {
-      current_status_.found++;
-      // PrintInfo(false);
-      characteristic_.GetCrypto()->Callback("found", characteristic_, rng_,
-                                            logfile_);
-      if (config_.GetSearchConfig().end_found) exit(0);
+  //! complete check
+  if (GetCurrentPhase().twobit_complete) {
+    int& complete_checks =
+        current_status_.complete_data[current_status_.phase * 2];
+    int& complete_success =
+        current_status_.complete_data[current_status_.phase * 2 + 1];
+    complete_checks++;
+    if (complete_checks > complete_limit * (1 + complete_success)) {
       Restart();
-      continue;
+      return;
+    }
+    complete_check_ = true;
+    if (!CompleteCheck(ComputeTwobitMask(2))) {
+      current_status_.remaining_credits--;
+      if (switched_back_or_stack_empty_) complete_check_ = true;
+      return;
     }
+    complete_check_ = false;
+    complete_success++;
+  }
+
+  //! crypto specific callback function
+  if (!characteristic_.GetCrypto()->Callback(
+          GetCurrentPhase().callback, characteristic_, rng_, logfile_)) {
+    // Restart();
+    BackTrack();
+    // guess_critical_bits_ = false;
+    return;
+  }
 
-    //! otherwise we move to the next phase
-    current_status_.phase++;
-    search_stack_.push_back(characteristic_, current_status_.phase);
+  //! if everything is ok, and it is the last phase, we found a characteristic
+  if (config_.IsLastSearchPhase(current_status_.phase)) {
+    current_status_.found++;
+    if (current_status_.first_found_time < 0)
+      current_status_.first_found_time =
+          std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                        current_status_.start_clock)
+              .count();
+    // PrintInfo(false);
+    characteristic_.GetCrypto()->Callback("found", characteristic_, rng_,
+                                          logfile_);
+    if (config_.GetSearchConfig().end_found) {
+      FlushLogs();
+      exit(0);
+    }
+    Restart();
+    return;
   }
-  assert(!"something wrong here");
-  exit(-1);
+
+  //! otherwise we move to the next phase
+  current_status_.phase++;
+  search_stack_.push_back(characteristic_, current_status_.phase);
 }
 
 Search::GuessTask Search::ChooseGuessPos() {
@@ -442,11 +534,12 @@ Search::GuessTask Search::ChooseGuessPos() {
                           ? searchmasks_[setting].First()
                           : searchmasks_[setting].GetRandomBitpos(rng_);
     PosCandidate pos = {startpos, initscore, setting};
-    return {GetSetting(pos.setting).guesses, pos.pos};
+    return {&GetSetting(pos.setting).guesses, pos.pos};
   } else if (strategy == "mcbranch" || strategy == "probbranch") {
     int setting = ChooseSetting();
     assert(setting >= 0);
-    std::vector<PosCandidate> candidates;
+    std::vector<PosCandidate>& candidates = candidates_;
+    candidates.clear();
     Bitpos startpos = GetSetting(setting).ordered_guesses
                           ? searchmasks_[setting].First()
                           : searchmasks_[setting].GetRandomBitpos(rng_);
@@ -461,7 +554,7 @@ Search::GuessTask Search::ChooseGuessPos() {
 
       candidates.emplace_back(pos);
       if (pos.value == -1)  // found a contradiction, return immediately
-        return {GetSetting(pos.setting).guesses, pos.pos};
+        return {&GetSetting(pos.setting).guesses, pos.pos};
       // if ((pos.setting = ChooseSetting()) < 0) // searchmasks for all
       // settings empty
       if (searchmasks_[pos.setting].GetNumBitsSet() <= free_limit) break;
@@ -475,10 +568,11 @@ Search::GuessTask Search::ChooseGuessPos() {
     // const int index = dist(rng_);
     // pos = candidates[index];
     pos = candidates[0];
-    return {GetSetting(pos.setting).guesses, pos.pos};
+    return {&GetSetting(pos.setting).guesses, pos.pos};
   } else {
     std::cerr << "Lookahead strategy \"" + strategy + "\" not implemented!"
               << std::endl;
+    Logfile::FlushAll();
     std::exit(-1);
   }
 }
@@ -491,10 +585,10 @@ void Search::EvaluatePos(PosCandidate& pos,
   if (!SetBitRandom(pos))
     pos.value = -1;
   else {
-    Bitmask& searchmask = searchmasks_[pos.setting];
-    searchmask = characteristic_.GetConditionMask(
-        searchmask,
-        std::bind(IsGuessable, GetSetting(pos.setting), std::placeholders::_1));
+    const Config::Setting& setting = GetSetting(pos.setting);
+    characteristic_.RestrictConditionMask(
+        searchmasks_[pos.setting],
+        [&setting](BitCondition bc) { return IsGuessable(setting, bc); });
     (this->*EvaluatePosValueFunc)(pos);
   }
   characteristic_.Undo();
@@ -503,12 +597,12 @@ void Search::EvaluatePos(PosCandidate& pos,
 
 //! evaluates the pos candidate based on the number of set bits
 void Search::EvaluatePosValueBitsSet(PosCandidate& pos) {
-  pos.value =
-      characteristic_
-          .GetConditionMask(initial_free_bits_mask_,
-                            std::bind(IsGuessable, GetSetting(pos.setting),
-                                      std::placeholders::_1))
-          .GetNumBitsSet();
+  const Config::Setting& setting = GetSetting(pos.setting);
+  free_bits_mask_ = initial_free_bits_mask_;
+  characteristic_.RestrictConditionMask(
+      free_bits_mask_,
+      [&setting](BitCondition bc) { return IsGuessable(setting, bc); });
+  pos.value = free_bits_mask_.GetNumBitsSet();
 }
 
 //! evaluates the pos candidate based on the probability
@@ -543,6 +637,7 @@ void Search::BackTrack() {
   switched_back_or_stack_empty_ |= search_stack_.empty();
   current_status_.remaining_credits--;
   current_status_.contradictions++;
+  current_status_.global_contradictions++;
 }
 
 int Search::BackTrackStrategy() {
@@ -551,11 +646,9 @@ int Search::BackTrackStrategy() {
   int phase = current_status_.phase;
 
   if (strategy == std::string("choice")) {
-    std::tie(characteristic_, phase) =
-        search_stack_.backtrack_to_other_choice();
+    phase = search_stack_.backtrack_to_other_choice(characteristic_);
   } else if (strategy == std::string("10perc")) {
-    std::tie(characteristic_, phase) =
-        search_stack_.backtrack(search_stack_.size() / 10);
+    phase = search_stack_.backtrack(search_stack_.size() / 10, characteristic_);
   } else if (strategy == std::string("custom")) {
     // implement custom BackTrack Strategy
   }
@@ -1,9 +1,10 @@
 #ifndef SEARCH_H_
 #define SEARCH_H_
 
+#include <chrono>
 #include <cstdint>
-#include <deque>
 #include <map>
+#include <memory>
 #include <random>
 #include <vector>
 
@@ -55,6 +56,11 @@ class Search {
     std::vector<int> complete_data;
     int dump_time;
     int dump_count;
+    int64_t global_contradictions;
+    int64_t guesses;
+    std::vector<double> phase_time;
+    std::chrono::steady_clock::time_point start_clock;
+    double first_found_time;
 
     void Init() {
       iterations = 0;
@@ -104,6 +110,43 @@ class Search {
       }
       return os;
     }
+
+    //! writes the status as comma separated JSON members
+    void WriteJsonFields(std::ostream& os) const {
+      int run_time = time(0) - start_time;
+      os << "\"seed\":" << seed;
+      os << ",\"time\":" << run_time;
+      const double elapsed = std::chrono::duration<double>(
+                                 std::chrono::steady_clock::now() - start_clock)
+                                 .count();
+      os << ",\"elapsed\":" << elapsed;
+      os << ",\"global_iterations\":" << global_iterations;
+      os << ",\"iterations_per_sec\":"
+         << (elapsed > 0 ? global_iterations / elapsed : 0);
+      // every guess is followed by one or two updates of the characteristic
+      os << ",\"guesses\":" << guesses;
+      os << ",\"guesses_per_sec\":" << (elapsed > 0 ? guesses / elapsed : 0);
+      os << ",\"iterations\":" << iterations;
+      os << ",\"stack_size\":" << stack_size;
+      os << ",\"contradictions\":" << contradictions;
+      os << ",\"global_contradictions\":" << global_contradictions;
+      os << ",\"restarts\":" << restarts;
+      os << ",\"minfree\":" << minfree;
+      os << ",\"absminfree\":" << absminfree;
+      os << ",\"credits\":" << remaining_credits;
+      os << ",\"phase\":" << phase;
+      os << ",\"found\":" << found;
+      os << ",\"first_found_time\":" << first_found_time;
+      os << ",\"smax\":" << max_stack_size;
+      os << ",\"complete\":[";
+      for (int i = 0; i <= phase; i++)
+        os << (i ? "," : "") << "{\"success\":" << complete_data[i * 2 + 1]
+           << ",\"checks\":" << complete_data[i * 2] << "}";
+      os << "],\"phase_time\":[";
+      for (int i = 0; i < phase_time.size(); i++)
+        os << (i ? "," : "") << phase_time[i];
+      os << "]";
+    }
   };
 
   /*!
@@ -172,10 +215,12 @@ class Search {
     std::string callback;
     bool end_found;
     int end_time;
+    int64_t end_iterations;
     int print_whole_characteristic;
     int print_info;
     int print_characteristic;
     int print_minfree;
+    std::string metrics_file;
     std::vector<Phase> phases;
   };
 
@@ -183,7 +228,7 @@ class Search {
    * \brief Representation of a guess of a bit, used to save critical bits.
    */
   struct GuessTask {
-    std::vector<Config::Guess> guesses;
+    const std::vector<Config::Guess>* guesses;
     Bitpos pos;
   };
 
@@ -194,8 +239,8 @@ class Search {
   void PrintInfo(bool print = false);
 
   void Restart();
-  bool CompleteCheck(Bitmask mask);
-  Bitmask ComputeTwobitMask(int threshold);
+  bool CompleteCheck(const Bitmask& mask);
+  const Bitmask& ComputeTwobitMask(int threshold);
 
   void UpdateStatus();
   bool UpdateMinfree();
@@ -204,6 +249,10 @@ class Search {
   bool Guess(GuessTask pos);
   bool GuessBit(Config::Guess guess, Bitpos pos);
   void Start();
+  //! initializes the search, called by Start
+  void Init();
+  //! a single iteration of the search loop, called by Start
+  void Iterate();
 
   GuessTask ChooseGuessPos();
   bool SetBitRandom(const PosCandidate& pos);
@@ -214,19 +263,25 @@ class Search {
 
   void SetDumpTime(int dump_time);
   void SetDumpCount(int dump_count);
+  void SetSnapshotInterval(int snapshot_interval);
   void CheckforDump();
+  void FlushLogs();
 
  private:
+  // TODO: back track limit is just hard coded for now
+  static constexpr int kCriticalBitsLimit = 10;
+
   const Config::Phase& GetCurrentPhase();
   const Config::Phase& GetLastPhase();
   const Config::Setting& GetSetting(int index);
   int ChooseSetting();
   int BackTrackStrategy();
+  void WriteMetrics();
   static bool IsGuessable(const Config::Setting& setting, BitCondition bc);
   bool GenerateSearchMasks(const std::vector<Config::Setting>& settings);
-  Bitmask GenerateWordMask(const Config::Setting& setting);
+  void GenerateWordMask(const Config::Setting& setting, Bitmask& mask);
 
-  std::deque<GuessTask> critical_bits_;
+  std::vector<GuessTask> critical_bits_;
   bool twobit_conditions_generated_;
   bool complete_check_;
   XmlConfig& config_;
@@ -236,10 +291,22 @@ class Search {
   Characteristic& characteristic_;
   std::vector<Bitmask> searchmasks_;
   Bitmask initial_free_bits_mask_;
+
+  // scratch buffers of the search loop, which keep their storage between
+  // iterations to avoid heap allocations
+  Bitmask free_bits_mask_;
+  Bitmask twobit_mask_;
+  Bitmask twobit_word_mask_;
+  std::vector<int> setting_indices_;
+  std::vector<double> setting_probabilities_;
+  std::vector<PosCandidate> candidates_;
+
   SearchStack search_stack_;
 
   Status current_status_;
   Logfile& logfile_;
+  std::unique_ptr<Logfile> metrics_;
+  std::chrono::steady_clock::time_point phase_clock_;
   bool guess_critical_bits_;
   bool switched_back_or_stack_empty_;
   int critical_bit_index_;
@@ -248,6 +315,9 @@ class Search {
   int seed_time_;
   int print_time_;
   int print_characteristic_time_;
+  // seconds between the snapshots of the caches, disabled if not positive
+  int snapshot_interval_;
+  int snapshot_time_;
 
   std::mt19937 rng_;
   std::ranlux24 real_rng_;
@@ -2,40 +2,55 @@
 
 #include <cassert>
 
-void SearchStack::clear() { search_stack_.clear(); }
+void SearchStack::clear() {
+  while (!search_stack_.empty()) pop_back();
+}
 
 bool SearchStack::empty() { return size() == 0; }
 
 int SearchStack::size() {
   int size = 0;
-  for (auto& el : search_stack_) size += el.guesses.size();
+  for (auto& el : search_stack_) size += el->guesses.size();
   return size;
 }
 
+void SearchStack::pop_back() {
+  unused_elements_.push_back(std::move(search_stack_.back()));
+  search_stack_.pop_back();
+}
+
 SearchStack::guess_container SearchStack::back_guess() {
   assert(!empty());  // given by caller
-  while (search_stack_.back().guesses.empty()) {
-    search_stack_.pop_back();
+  while (back().guesses.empty()) {
+    pop_back();
   }
 
-  auto ret = search_stack_.back().guesses.back();
-  search_stack_.back().guesses.pop_back();
+  auto ret = back().guesses.back();
+  back().guesses.pop_back();
   return ret;
 }
 
 void SearchStack::push_back(const Characteristic& characteristic, int phase) {
-  search_stack_.push_back(StackElement(characteristic, phase));
+  if (unused_elements_.empty()) {
+    search_stack_.emplace_back(new StackElement(characteristic, phase));
+    back().guesses.reserve(frequency_);
+    return;
+  }
+  search_stack_.push_back(std::move(unused_elements_.back()));
+  unused_elements_.pop_back();
+  back().characteristic = characteristic;
+  back().guesses.clear();
+  back().phase = phase;
 }
 
 void SearchStack::add_guess(const Characteristic& c, const Bitpos& pos,
                             const BitCondition& cond) {
   assert(!search_stack_.empty());
-  search_stack_.back().guesses.emplace_back(
-      pos, std::make_pair(cond, BitCondition("#")));
+  back().guesses.emplace_back(pos, std::make_pair(cond, BitCondition("#")));
 
   // every frequency_ guesses, put a copy of the characteristic on the stack
-  if (search_stack_.back().guesses.size() >= frequency_) {
-    push_back(c, search_stack_.back().phase);
+  if (back().guesses.size() >= frequency_) {
+    push_back(c, back().phase);
   }
 }
 
@@ -43,63 +58,64 @@ void SearchStack::add_guess(const Characteristic& c, const Bitpos& pos,
                             const BitCondition& cond1,
                             const BitCondition& cond2) {
   assert(!search_stack_.empty());
-  search_stack_.back().guesses.emplace_back(pos, std::make_pair(cond1, cond2));
+  back().guesses.emplace_back(pos, std::make_pair(cond1, cond2));
 
   // every frequency_ guesses, put a copy of the characteristic on the stack
-  if (search_stack_.back().guesses.size() >= frequency_) {
-    push_back(c, search_stack_.back().phase);
+  if (back().guesses.size() >= frequency_) {
+    push_back(c, back().phase);
   }
 }
 
-std::pair<Characteristic, int> SearchStack::get_pop_back() {
+int SearchStack::get_pop_back(Characteristic& characteristic) {
   assert(!search_stack_.empty());
-  std::pair<Characteristic, int> ret = std::make_pair(
-      search_stack_.back().characteristic, search_stack_.back().phase);
-  for (auto& guess : search_stack_.back().guesses) {
-    ret.first.SetBitCondition(guess.first, guess.second.first);
+  characteristic = back().characteristic;
+  const int phase = back().phase;
+  for (auto& guess : back().guesses) {
+    characteristic.SetBitCondition(guess.first, guess.second.first);
   }
-  assert(ret.first.Update(true));  // there should only be doable guesses on the
-                                   // first pos of the stack
-
-  if (search_stack_.back().guesses.empty()) {
-    search_stack_.pop_back();
-    if (!search_stack_.empty() && !search_stack_.back().guesses.empty())
-      search_stack_.back().guesses.pop_back();
+  // there should only be doable guesses on the first pos of the stack
+  const bool updated = characteristic.Update(true);
+  assert(updated);
+  (void)updated;
+
+  if (back().guesses.empty()) {
+    pop_back();
+    if (!search_stack_.empty() && !back().guesses.empty())
+      back().guesses.pop_back();
   } else
-    search_stack_.back().guesses.pop_back();
+    back().guesses.pop_back();
 
-  return ret;
+  return phase;
 }
 
-std::pair<Characteristic, int> SearchStack::backtrack(int steps) {
+int SearchStack::backtrack(int steps, Characteristic& characteristic) {
   assert(!search_stack_.empty());
 
-  while (steps > search_stack_.back().guesses.size() &&
-         search_stack_.size() > 1) {
-    steps -= search_stack_.back().guesses.size();
-    search_stack_.pop_back();
+  while (steps > back().guesses.size() && search_stack_.size() > 1) {
+    steps -= back().guesses.size();
+    pop_back();
   }
-  std::pair<Characteristic, int> ret = std::make_pair(
-      search_stack_.back().characteristic, search_stack_.back().phase);
-  if (steps > search_stack_.back().guesses.size()) {
-    search_stack_.back().guesses.clear();
-    return ret;
+  characteristic = back().characteristic;
+  if (steps > back().guesses.size()) {
+    back().guesses.clear();
+    return back().phase;
   }
 
   // discard "steps" guesses
-  search_stack_.back().guesses.resize(search_stack_.back().guesses.size() -
-                                      steps);
+  back().guesses.resize(back().guesses.size() - steps);
 
   // redo guesses
-  for (auto& guess : search_stack_.back().guesses) {
-    ret.first.SetBitCondition(guess.first, guess.second.first);
+  for (auto& guess : back().guesses) {
+    characteristic.SetBitCondition(guess.first, guess.second.first);
   }
-  assert(ret.first.Update(
-      true));  // there should only be doable guesses on the stack
-  return ret;
+  // there should only be doable guesses on the stack
+  const bool updated = characteristic.Update(true);
+  assert(updated);
+  (void)updated;
+  return back().phase;
 }
 
-std::pair<Characteristic, int> SearchStack::backtrack_to_other_choice() {
+int SearchStack::backtrack_to_other_choice(Characteristic& characteristic) {
   assert(!search_stack_.empty());
 
   auto selector = [](std::pair<BitCondition, BitCondition> conds) {
@@ -107,33 +123,34 @@ std::pair<Characteristic, int> SearchStack::backtrack_to_other_choice() {
   };
   do {
     if (empty()) {
-      return std::make_pair(search_stack_.back().characteristic,
-                            search_stack_.back().phase);
+      characteristic = back().characteristic;
+      return back().phase;
     }
     // pop all that do not have a second choice
     guess_container other_choice;
     for (other_choice = back_guess(); selector(other_choice.second);
          other_choice = back_guess()) {
       if (empty()) {
-        return std::make_pair(search_stack_.back().characteristic,
-                              search_stack_.back().phase);
+        characteristic = back().characteristic;
+        return back().phase;
       }
     }
 
-    std::pair<Characteristic, int> ret = std::make_pair(
-        search_stack_.back().characteristic, search_stack_.back().phase);
+    characteristic = back().characteristic;
 
     // redo guesses
-    for (auto& guess : search_stack_.back().guesses) {
-      ret.first.SetBitCondition(guess.first, guess.second.first);
+    for (auto& guess : back().guesses) {
+      characteristic.SetBitCondition(guess.first, guess.second.first);
     }
 
     // use other choice
-    ret.first.SetBitCondition(other_choice.first, other_choice.second.second);
+    characteristic.SetBitCondition(other_choice.first,
+                                   other_choice.second.second);
 
-    if (ret.first.Update(true)) {
-      add_guess(ret.first, other_choice.first, other_choice.second.second);
-      return ret;
+    if (characteristic.Update(true)) {
+      const int phase = back().phase;
+      add_guess(characteristic, other_choice.first, other_choice.second.second);
+      return phase;
     }
   } while (1);
 }
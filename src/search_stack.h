@@ -2,6 +2,7 @@
 #define NLDTOOL_SEARCH_STACK_H
 
 #include <map>
+#include <memory>
 #include <utility>
 #include <vector>
 
@@ -19,6 +20,9 @@
  * full_save_frequency guesses, the whole \see Characteristic is placed on the
  * stack. The wanted state for pop operations is build back up from the last
  * full state and the guesses following it.
+ *
+ * Popped elements are kept and reused by later pushes, so that the
+ * characteristics on the stack are not reallocated during the search.
  */
 class SearchStack {
   typedef std::pair<Bitpos, std::pair<BitCondition, BitCondition>>
@@ -38,15 +42,12 @@ class SearchStack {
 
     StackElement(const Characteristic& c, int phase)
         : characteristic(c), guesses(), phase(phase) {}
-    StackElement(StackElement&& s)
-        : characteristic(std::move(s.characteristic)),
-          guesses(std::move(s.guesses)),
-          phase(s.phase) {}
     StackElement() = delete;
     StackElement(const StackElement&) = delete;
     StackElement& operator=(const StackElement&) = delete;
     StackElement& operator=(StackElement&&) = delete;
   };
+  typedef std::unique_ptr<StackElement> StackElementPtr;
 
  public:
   SearchStack(int full_save_frequency = 20) : frequency_(full_save_frequency) {}
@@ -56,16 +57,21 @@ class SearchStack {
                  const BitCondition& cond);
   void add_guess(const Characteristic& c, const Bitpos& pos,
                  const BitCondition& cond1, const BitCondition& cond2);
-  std::pair<Characteristic, int> get_pop_back();
-  std::pair<Characteristic, int> backtrack(int steps);
-  std::pair<Characteristic, int> backtrack_to_other_choice();
+  // the following functions write the restored state to characteristic and
+  // return its phase
+  int get_pop_back(Characteristic& characteristic);
+  int backtrack(int steps, Characteristic& characteristic);
+  int backtrack_to_other_choice(Characteristic& characteristic);
   void clear();
   int size();
   bool empty();
 
  private:
   guess_container back_guess();
-  std::vector<StackElement> search_stack_;
+  StackElement& back() { return *search_stack_.back(); }
+  void pop_back();
+  std::vector<StackElementPtr> search_stack_;
+  std::vector<StackElementPtr> unused_elements_;
   int frequency_;
 };
 
@@ -14,6 +14,7 @@ set(NLDCORE_FILES
   src/cache_base.h
   src/cache_manager.cpp
   src/cache_manager.h
+  src/carry_automaton.h
   src/carry_step.h
   src/change.cpp
   src/change.h
@@ -21,6 +22,7 @@ set(NLDCORE_FILES
   src/characteristic.h
   src/condition.cpp
   src/condition.h
+  src/condition_access.h
   src/condition_container.h
   src/condition_proxy.cpp
   src/condition_proxy.h
@@ -35,6 +37,7 @@ set(NLDCORE_FILES
   src/functions.h
   src/horizontal_condition_word.cpp
   src/horizontal_condition_word.h
+  src/huge_page_allocator.h
   src/index.h
   src/konstant_condition_proxy.cpp
   src/konstant_condition_proxy.h
@@ -47,6 +50,7 @@ set(NLDCORE_FILES
   src/linear_step.h
   src/linear_step_data.h
   src/linkable_condition_proxy.h
+  src/logfile.cpp
   src/logfile.h
   src/managable_cache.cpp
   src/managable_cache.h
@@ -67,11 +71,13 @@ set(NLDCORE_FILES
   src/probability_output.h
   src/probability_output_matrix.cpp
   src/probability_output_matrix.h
+  src/probability_output_sparse_matrix.h
   src/propagate.h
   src/propagate_twobit.h
   src/propagate_twobit_output.cpp
   src/propagate_twobit_output.h
   src/row.h
+  src/sbox_table.h
   src/search.cpp
   src/search.h
   src/search_stack.cpp
@@ -80,6 +86,7 @@ set(NLDCORE_FILES
   src/step.h
   src/step_data.h
   src/step_update.h
+  src/step_update_queue.h
   src/text_io_format.cpp
   src/text_io_format.h
   src/tinyset.h
@@ -92,4 +99,5 @@ set(NLDCORE_FILES
   src/word_container.h
   src/xml_config.cpp
   src/xml_config.h
+  src/xor_sumset.h
 )
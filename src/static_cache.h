@@ -8,9 +8,11 @@
 #include <cstdint>
 #include <fstream>
 #include <iostream>
+#include <string>
 #include <vector>
 
 #include "cache_base.h"
+#include "huge_page_allocator.h"
 
 /*!
  * \brief Small cache for functions with small number of in- and outputs,
@@ -22,7 +24,10 @@
 template <class Key, class Data>
 class StaticCache : public CacheBase<Key, Data> {
  public:
-  StaticCache() { is_initialized_ = false; }
+  StaticCache() {
+    is_initialized_ = false;
+    snapshot_taken_ = false;
+  }
 
   virtual ~StaticCache() {}
 
@@ -46,6 +51,11 @@ class StaticCache : public CacheBase<Key, Data> {
     return match;
   }
 
+  virtual bool Find(const Key key, Data& data) {
+    data = data_[key];
+    return true;
+  }
+
   virtual bool LoadDump() {
     if (this->filepath == nullptr) return false;
     FILE* file = fopen(this->filepath, "r");
@@ -71,6 +81,20 @@ class StaticCache : public CacheBase<Key, Data> {
     return true;
   }
 
+  virtual bool TakeSnapshot(CacheSnapshot& snapshot, bool full) {
+    // the entries do not change after the initialization, so they are only
+    // written with the first snapshot
+    if (this->filepath == nullptr || data_.empty()) return false;
+    if (snapshot_taken_ && !full) return false;
+    snapshot.filepath = this->filepath;
+    snapshot.append = false;
+    snapshot.bytes.clear();
+    for (const Data& data : data_)
+      snapshot.bytes.append(data.GetBytePtr(), data.GetByteSize());
+    snapshot_taken_ = true;
+    return true;
+  }
+
   virtual bool SaveDump() {
     if (this->filepath == nullptr) return false;
     if (data_.size() <= 0) return true;
@@ -94,9 +118,10 @@ class StaticCache : public CacheBase<Key, Data> {
   }
 
  private:
-  typedef std::vector<Data> CacheMap;
+  typedef HugePageVector<Data> CacheMap;
   CacheMap data_;
   bool is_initialized_;
+  bool snapshot_taken_;
 };
 
 #endif  // STATIC_CACHE_H_
@@ -5,10 +5,12 @@
 #include <vector>
 
 #include "bitpos.h"
+#include "condition_access.h"
 #include "condition_word.h"
 #include "twobit_condition.h"
 
 class Characteristic;
+class Crypto;
 class StepData;
 
 struct Overlap {
@@ -71,13 +73,15 @@ class Step {
 
   virtual bool IsCarryStep() { return false; }
 
+  virtual bool IsLinearStep() const { return false; }
+
   virtual StepData* CreateStepData() const = 0;
 
   virtual void Init(int step_index, Priority priority) = 0;
 
   virtual void AddOverlap(Overlap overlap) { overlap_.push_back(overlap); }
 
-  const ConditionWordPtr GetParam(int i) const { return params_[i]; }
+  const ConditionWordPtr& GetParam(int i) const { return params_[i]; }
 
   void AddParam(ConditionWordPtr a) { params_.push_back(a); }
 
@@ -100,12 +104,22 @@ class Step {
   virtual bool Update(Characteristic& characteristic, int pos,
                       bool backtrack = false) const = 0;
 
+  //! hints the caches used by Update for the given bits, before they are
+  //! updated one after another
+  virtual void Prefetch(const Characteristic& characteristic,
+                        uint64_t bits) const {}
+
+  //! resolves the condition proxies used in Update, \see ConditionAccess
+  virtual void CompileConditionAccess(Crypto& crypto) {}
+
   virtual float GetProbability(const Characteristic& characteristic) const {
     return 0.0;
   }
 
-  virtual std::vector<TwobitCondition> UpdateTwobitCondition(
-      Characteristic& characteristic, Bitpos bitslice_pos) const = 0;
+  //! appends the twobit conditions of the bitslice at bitslice_pos to twobit
+  virtual void UpdateTwobitCondition(
+      Characteristic& characteristic, Bitpos bitslice_pos,
+      std::vector<TwobitCondition>& twobit) const = 0;
 
   virtual bool PropagateConditions(Characteristic& characteristic) const {
     return true;
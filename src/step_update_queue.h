@@ -0,0 +1,76 @@
+#ifndef STEP_UPDATE_QUEUE_H_
+#define STEP_UPDATE_QUEUE_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "step_update.h"
+
+/*!
+ * \brief Priority queue of the step bits waiting for an update.
+ *
+ * The pending updates are kept as a binary heap (smallest StepUpdate first)
+ * in a vector, and a bitmap marks the queued (step, bit) pairs. Pushing and
+ * popping do not allocate once the vector has grown. Since every step has a
+ * fixed priority, the updates are popped in the same order as from a
+ * std::set<StepUpdate>.
+ */
+class StepUpdateQueue {
+ public:
+  explicit StepUpdateQueue(int num_steps = 0) : queued_(num_steps, 0) {}
+
+  bool Empty() const { return heap_.empty(); }
+
+  const StepUpdate& Top() const {
+    assert(!heap_.empty());
+    return heap_.front();
+  }
+
+  // the bits of the step that are queued or currently being updated
+  uint64_t GetQueuedBits(int step) const { return queued_[step]; }
+
+  void Push(const StepUpdate& update) {
+    uint64_t& queued = queued_[update.step];
+    const uint64_t bit = 1ull << update.bit;
+    if (queued & bit) return;
+    queued |= bit;
+    heap_.push_back(update);
+    std::push_heap(heap_.begin(), heap_.end(), Greater);
+  }
+
+  // removes the top update from the heap; it still counts as queued (further
+  // pushes are ignored) until it is released
+  StepUpdate Pop() {
+    assert(!heap_.empty());
+    std::pop_heap(heap_.begin(), heap_.end(), Greater);
+    const StepUpdate update = heap_.back();
+    heap_.pop_back();
+    return update;
+  }
+
+  void Release(const StepUpdate& update) {
+    queued_[update.step] &= ~(1ull << update.bit);
+  }
+
+  void Clear() {
+    heap_.clear();
+    std::fill(queued_.begin(), queued_.end(), 0);
+  }
+
+  void Swap(StepUpdateQueue& other) {
+    heap_.swap(other.heap_);
+    queued_.swap(other.queued_);
+  }
+
+ private:
+  static bool Greater(const StepUpdate& lhs, const StepUpdate& rhs) {
+    return rhs < lhs;
+  }
+
+  std::vector<StepUpdate> heap_;
+  std::vector<uint64_t> queued_;
+};
+
+#endif  // STEP_UPDATE_QUEUE_H_
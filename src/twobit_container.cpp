@@ -15,6 +15,11 @@ TwobitContainer::TwobitContainer(const TwobitContainer& s)
       twobit_conditions_(s.twobit_conditions_),
       twobit_degree_(s.twobit_degree_) {}
 
+TwobitContainer::TwobitContainer(TwobitContainer&& s) noexcept
+    : crypto_(s.crypto_),
+      twobit_conditions_(std::move(s.twobit_conditions_)),
+      twobit_degree_(std::move(s.twobit_degree_)) {}
+
 TwobitContainer::~TwobitContainer() {}
 
 TwobitContainer& TwobitContainer::operator=(const TwobitContainer& s) {
@@ -24,6 +29,13 @@ TwobitContainer& TwobitContainer::operator=(const TwobitContainer& s) {
   return *this;
 }
 
+TwobitContainer& TwobitContainer::operator=(TwobitContainer&& s) noexcept {
+  assert(crypto_.get() == s.crypto_.get());
+  twobit_conditions_.swap(s.twobit_conditions_);
+  twobit_degree_.swap(s.twobit_degree_);
+  return *this;
+}
+
 void TwobitContainer::ClearTwobitConditions() {
   twobit_conditions_.clear();
   for (int pos = 0; pos < twobit_degree_.size(); ++pos) twobit_degree_[pos] = 0;
@@ -54,8 +66,8 @@ int TwobitContainer::GetIndexFromBitpos(Bitpos pos) {
 
 void TwobitContainer::GenerateTwobitConditions(Characteristic& characteristic) {
   Bitmask& twobit_bitslice_update_mask = characteristic.GetTwobitUpdateMask();
-  std::vector<Bitpos> twobit_bitslice_update_list =
-      twobit_bitslice_update_mask.GetBitposList();
+  std::vector<Bitpos>& twobit_bitslice_update_list = update_list_;
+  twobit_bitslice_update_mask.GetBitposList(twobit_bitslice_update_list);
 
   //  std::cout << "twobit_update_list_ (" << twobit_bitslice_update_list.size()
   //  << ")" << std::endl; for (int i=0; i<twobit_bitslice_update_list.size();
@@ -65,12 +77,13 @@ void TwobitContainer::GenerateTwobitConditions(Characteristic& characteristic) {
 
   ClearTwobitConditions();
   twobit_conditions_.reserve(1000);
-  std::vector<TwobitCondition> temp;
+  std::vector<TwobitCondition>& temp = step_twobit_conditions_;
 
   for (int i = 0; i < twobit_bitslice_update_list.size(); i++) {
     const Bitpos pos = twobit_bitslice_update_list.at(i);
-    temp = crypto_->GetStep(pos.GetWord())
-               .UpdateTwobitCondition(characteristic, pos);
+    temp.clear();
+    crypto_->GetStep(pos.GetWord())
+        .UpdateTwobitCondition(characteristic, pos, temp);
     // if there is no twobit condition, clear bit in twobit update mask
     if (temp.size() == 0) twobit_bitslice_update_mask.ClearBit(pos);
     for (int j = 0; j < temp.size(); j++) {
@@ -100,16 +113,19 @@ void TwobitContainer::GenerateTwobitConditions(Characteristic& characteristic) {
 
 Bitmask TwobitContainer::GetTwobitDegreeMask(const int th) {
   Bitmask mask(crypto_->GetWordSize());
+  GetTwobitDegreeMask(th, mask);
+  return mask;
+}
 
+void TwobitContainer::GetTwobitDegreeMask(const int th, Bitmask& mask) {
   assert(th > 0);
 
+  mask.ClearAll();
   for (int i = 0; i < crypto_->GetNumWords() * crypto_->GetWordSize(); i++) {
     if (twobit_degree_[i] >= th) {
       mask.SetBit(i);
     }
   }
-
-  return mask;
 }
 
 std::vector<uint8_t> TwobitContainer::GetTwobitDegrees() const {
@@ -28,7 +28,9 @@ class TwobitContainer {
  public:
   TwobitContainer(CryptoPtr crypto);
   TwobitContainer(const TwobitContainer& s);
+  TwobitContainer(TwobitContainer&& s) noexcept;
   TwobitContainer& operator=(const TwobitContainer& s);
+  TwobitContainer& operator=(TwobitContainer&& s) noexcept;
   virtual ~TwobitContainer();
 
   void GenerateTwobitConditions(Characteristic& characteristic);
@@ -39,6 +41,7 @@ class TwobitContainer {
   void IncTwobitDegree(Bitpos pos);
   std::vector<uint8_t> GetTwobitDegrees() const;
   Bitmask GetTwobitDegreeMask(int th = 1);
+  void GetTwobitDegreeMask(int th, Bitmask& mask);
   int ComputeTwobitDegrees();
   int GetIndexFromBitpos(Bitpos pos);
 
@@ -46,6 +49,10 @@ class TwobitContainer {
   CryptoPtr crypto_;
   std::vector<TwobitCondition> twobit_conditions_;
   std::vector<uint8_t> twobit_degree_;
+
+  // scratch buffers of GenerateTwobitConditions (not copied)
+  std::vector<Bitpos> update_list_;
+  std::vector<TwobitCondition> step_twobit_conditions_;
 };
 
 #endif  // TWOBIT_CONTAINER_H_
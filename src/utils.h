@@ -14,6 +14,16 @@ inline int HammingWeight(T v) {
   return (T)(v * ((T) ~(T)0 / 255)) >> (sizeof(T) - 1) * 8;
 }
 
+// the index of the least significant set bit, x must not be 0
+inline int CountTrailingZeros(uint64_t x) {
+  assert(x != 0);
+#ifdef __GNUC__
+  return __builtin_ctzll(x);
+#else
+  return HammingWeight((x & (0 - x)) - 1);
+#endif
+}
+
 template <class T>
 inline T LeastSignificantSetBitmask(T x) {
   return x & ~(x - 1);
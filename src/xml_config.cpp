@@ -92,6 +92,7 @@ XmlConfig::XmlConfig(cxxopts::Options& options, bool override_old_options)
       options_(options),
       characteristicstream_(std::stringstream::in | std::stringstream::out),
       crypto_(nullptr),
+      crypto_pool_(nullptr),
       characteristic_(nullptr) {}
 
 XmlConfig::~XmlConfig() { delete characteristic_; }
@@ -292,7 +293,25 @@ void XmlConfig::PrintOptions(Logfile& logfile) {
 }
 
 void XmlConfig::GenerateCrypto() {
+  if (crypto_pool_ && crypto_pool_->count(crypto_key_)) {
+    crypto_ = crypto_pool_->at(crypto_key_);
+    return;
+  }
   crypto_ = std::shared_ptr<Crypto>(CryptoFactory(options_));
+  crypto_->SetName(options_["function"].as<std::string>());
+  crypto_->SetNumRounds(options_["num-rounds"].as<int>());
+  if (crypto_pool_) (*crypto_pool_)[crypto_key_] = crypto_;
+}
+
+void XmlConfig::SetCryptoPool(CryptoPool* pool) { crypto_pool_ = pool; }
+
+std::string XmlConfig::GetOptionsKey(const std::string& configfile) {
+  tinyxml2::XMLDocument doc;
+  if (doc.LoadFile(configfile.c_str()) != tinyxml2::XMLError::XML_SUCCESS)
+    return "";
+  tinyxml2::XMLElement* root = doc.FirstChildElement("config");
+  if (root == NULL) return "";
+  return OptionsKey(root->FirstChildElement("options"));
 }
 
 Characteristic XmlConfig::GenerateCharacteristic() {
@@ -300,6 +319,14 @@ Characteristic XmlConfig::GenerateCharacteristic() {
   crypto_->GetTextIOFormat()->SetPrintConfig(GetPrintConfig());
   if (GetPrintMainSteps()) crypto_->GetTextIOFormat()->SetPrintOnlyMainSteps();
   if (GetPrintAllSteps()) crypto_->GetTextIOFormat()->SetPrintMainAndSubSteps();
+  if (!characteristic_ && options_.count("binary-input")) {
+    characteristic_ = new Characteristic(crypto_);
+    if (!characteristic_->ReadBinary(
+            options_["binary-input"].as<std::string>())) {
+      Logfile::FlushAll();
+      exit(-1);
+    }
+  }
   if (!characteristic_ && !options_["input-file"].as<std::string>().empty()) {
     characteristic_ = new Characteristic(crypto_);
     characteristic_->ReadCharacteristic(GetCharacteristicStream(),
@@ -395,6 +422,8 @@ void XmlConfig::InsertExternalSearchConfig(const std::string& searchconfigfile,
 }
 
 void XmlConfig::Error(const char* format, ...) {
+  // the queued log output comes before the error
+  Logfile::FlushAll();
   va_list argptr;
   va_start(argptr, format);
   printf("ERROR: XML config - ");
@@ -428,9 +457,24 @@ void XmlConfig::HandleOptions(tinyxml2::XMLElement* option) {
     }
     e = e->NextSiblingElement();
   } while (e);
+  crypto_key_ = OptionsKey(option);
   GenerateCrypto();
 }
 
+std::string XmlConfig::OptionsKey(tinyxml2::XMLElement* option) {
+  // the options from the command line are the same for all files
+  std::string key;
+  if (option == NULL) return key;
+  for (tinyxml2::XMLElement* e = option->FirstChildElement(); e;
+       e = e->NextSiblingElement()) {
+    key += e->Attribute("name") ? e->Attribute("name") : "";
+    key += "=";
+    key += e->Attribute("value") ? e->Attribute("value") : "";
+    key += ";";
+  }
+  return key;
+}
+
 void XmlConfig::HandleCharacteristic(tinyxml2::XMLElement* characteristic) {
   if (characteristic->Attribute("value") == NULL)
     Error("an attribute 'value' must be defined in element <char>");
@@ -441,10 +485,14 @@ void XmlConfig::HandleSearch(tinyxml2::XMLElement* xml_search) {
   // set search options
   searchconfig_.end_found = options_["end-found"].as<bool>();
   searchconfig_.end_time = options_["end-time"].as<int>();
+  searchconfig_.end_iterations = options_["end-iterations"].as<int64_t>();
   searchconfig_.print_whole_characteristic = 0;
   searchconfig_.print_info = options_["print-info"].as<int>();
   searchconfig_.print_characteristic = options_["print-char"].as<int>();
   searchconfig_.print_minfree = options_["minfree-threshold"].as<int>();
+  searchconfig_.metrics_file = options_.count("metrics-file")
+                                   ? options_["metrics-file"].as<std::string>()
+                                   : "";
   // default search attributes
   searchconfig_.seed = -1;
   searchconfig_.reseed = -1;
@@ -33,6 +33,9 @@ class Logfile;
  */
 class XmlConfig {
  public:
+  // cryptos shared by several configs, keyed by the options of their XML files
+  typedef std::map<std::string, std::shared_ptr<Crypto>> CryptoPool;
+
   XmlConfig(cxxopts::Options& options, bool override_old_options = false);
 
   ~XmlConfig();
@@ -70,6 +73,15 @@ class XmlConfig {
 
   void GenerateCrypto();
 
+  // reuse the crypto of an earlier config with the same options; the
+  // cryptos only depend on the options and are not changed by a
+  // characteristic
+  void SetCryptoPool(CryptoPool* pool);
+
+  // the key of the options of an XML file in a crypto pool, empty if the
+  // file can not be read
+  static std::string GetOptionsKey(const std::string& configfile);
+
   Characteristic GenerateCharacteristic();
 
   void PrintSearchConfig(Logfile& logfile);
@@ -91,6 +103,8 @@ class XmlConfig {
 
   void HandleOptions(tinyxml2::XMLElement* option);
 
+  static std::string OptionsKey(tinyxml2::XMLElement* option);
+
   void HandleCharacteristic(tinyxml2::XMLElement* characteristic);
 
   void HandleSearch(tinyxml2::XMLElement* xml_search);
@@ -114,6 +128,8 @@ class XmlConfig {
   PrintConfig print_config_;
   Search::Config searchconfig_;
   std::shared_ptr<Crypto> crypto_;
+  CryptoPool* crypto_pool_;
+  std::string crypto_key_;
   Characteristic* characteristic_;
 };
 #endif  // XML_CONFIG_H_
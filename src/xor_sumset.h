@@ -0,0 +1,97 @@
+#ifndef XOR_SUMSET_H_
+#define XOR_SUMSET_H_
+
+#include <cstdint>
+
+#include "bitslice_data.h"
+#include "functions.h"
+#include "utils.h"
+
+/*!
+ * \brief Propagation of a bitslice function with the sums of sets of pairs
+ * instead of enumerating all pairs.
+ *
+ * The default does not know the function, so \see Bitslice uses the cache and
+ * the \see Loop for it.
+ */
+template <class F>
+class XorSumset {
+ public:
+  static const bool kEnabled = false;
+
+  static BitsliceData<F> Propagate(const BitsliceData<F>& input) {
+    return input;
+  }
+};
+
+/*!
+ * \brief Sums of sets of pairs for an XOR of conditions with the given number
+ * of bits.
+ *
+ * A condition is the set of allowed pairs, and the pairs of an XOR add up
+ * bitwise. So a pair of one condition is possible if it is in the sum of the
+ * sets of all other conditions. These sums are built from the sums of all
+ * conditions before it (before[i]) and after it (after[i]). The result is
+ * exactly that of \see Propagate in the \see Loop (checked by nldpropcheck),
+ * without a cache.
+ *
+ * The static cache of XOR<2> fits into the L1 cache and is faster, so only
+ * larger functions use the sums.
+ */
+template <class F>
+class XorSumsetBase {
+ public:
+  static const bool kEnabled = BitsliceData<F>::NUMBITS > 12;
+
+  static BitsliceData<F> Propagate(const BitsliceData<F>& input) {
+    uint64_t cond[kNumConditions];
+    uint64_t before[kNumConditions];
+    uint64_t after[kNumConditions];
+    for (int i = 0; i < kNumConditions; i++) cond[i] = input.GetCondition(i);
+    before[1] = cond[0];
+    for (int i = 2; i < kNumConditions; i++)
+      before[i] = Sum(before[i - 1], cond[i - 1]);
+    after[kNumConditions - 2] = cond[kNumConditions - 1];
+    for (int i = kNumConditions - 3; i >= 0; i--)
+      after[i] = Sum(after[i + 1], cond[i + 1]);
+
+    // if there is no solution, all conditions become empty like in the Loop
+    BitsliceData<F> output;
+    output.SetCondition(0, cond[0] & after[0]);
+    for (int i = 1; i < kNumConditions - 1; i++)
+      output.SetCondition(i, cond[i] & Sum(before[i], after[i]));
+    output.SetCondition(kNumConditions - 1, cond[kNumConditions - 1] &
+                                                before[kNumConditions - 1]);
+    return output;
+  }
+
+ private:
+  static const int kNumConditions = F::kNumInputs + F::kNumOutputs;
+  static const int kNumPairs = 1 << (2 * F::Bitsize(0));
+
+  // adds the pair with bit j set to all pairs in x
+  static uint64_t Swap(uint64_t x, int j) {
+    static const uint64_t kMask[4] = {0x5555, 0x3333, 0x0f0f, 0x00ff};
+    const int width = 1 << j;
+    return ((x & kMask[j]) << width) | ((x >> width) & kMask[j]);
+  }
+
+  // all sums of a pair in a and a pair in b, going through the pairs of a in
+  // Gray code order so that b changes by one swap per pair
+  static uint64_t Sum(uint64_t a, uint64_t b) {
+    uint64_t sum = -(a & 1) & b;
+    for (int k = 1; k < kNumPairs; k++) {
+      b = Swap(b, nldtool::CountTrailingZeros(k));
+      sum |= -((a >> (k ^ (k >> 1))) & 1) & b;
+    }
+    return sum;
+  }
+};
+
+template <int N>
+class XorSumset<XOR<N>> : public XorSumsetBase<XOR<N>> {};
+
+template <int N>
+class XorSumset<XORB<N>> : public XorSumsetBase<XORB<N>> {};
+
+#endif  // XOR_SUMSET_H_